@@ -2,429 +2,859 @@
 ///// CS33211-001
 ///// Banker's Algorithm for Deadlock Avoidance
 ///// ===========
-///// v1.2.3
+///// v1.19.4
 ///// For fixed number of processes, and fixed amount of resources, given a
 /////     system state (via file), will attempt to find a 'safe' allocation
 /////     sequence for the current system state. If found, will printf the 
 /////     sequence, otherwise will print that system is in unsafe state.
-///// - Compile via > gcc bankersAlgo.c -o bankersAlgo
+///// - Compile via > ./buildScript.sh (builds libbankers.a/.so from bankersLib.c, then links this CLI + bankersIO.c against it)
 ///// - Run via > ./bankerAlgo ./INPUT_FILE.txt
+/////     - Option -p : always queue lowest index ready process first (P0 before P1, original v1.2.3 ordering)
+/////     - Option -b : batch, evaluate every snapshot of every input (back-to-back snapshots allowed, '-' is stdin), one verdict line each
+/////     - Option -c IN OUT : convert snapshots between text and binary (direction from IN), binary inputs are detected and mapped in place
+/////     - Option -k KERNELS : row kernels (auto, scalar, sse2, avx2), all give identical results. Option -n : 16-bit lanes for -i re-checks when values fit
+/////     - Option -j N : split safety checks over N threads, sequence built in rounds (same for any N). Add -s (or -p) to keep the single-thread sequence
+/////     - Option -o MODE : full (default), diff (changed row + Avail per step), sequence, verdict, json, csv. Last four are untagged, without INFO lines
+/////     - Option -z STORAGE : auto (default), dense or sparse need/alloc storage. Auto is sparse for big mapped text inputs with few non-zero values
+/////     - Option -i : keep state loaded and answer 'REQUEST Pi v..', 'RELEASE Pi v..', 'ADD Pi max..', 'QUERY', 'QUIT' lines from stdin
+/////     - Option -w FILE : what-if, evaluate every candidate line ('Pi v..', REQUEST optional) on its own against the loaded state, prints grant bitmap (malformed lines stay in place, reported invalid)
+/////     - Option -m PROCESS : headroom, largest safe grant of each resource for process (Pi, or 'all' for the rows*cols matrix)
+/////     - Option -q ORDER : pick among ready processes by priority (lowest first), weight (heaviest first) or shortest (least total need first),
+/////         from an optional 'priority weight' section after the available array, and report weighted completion cost
+/////     - Option --stats (or --stats=json) : phase times, check counters, bytes parsed/written and peak memory after the result (not for -b/-c)
 ///// - Clean output (without debug messages/tags) > ./bankerAlgo ./INPUT_FILE.txt | grep OUTPUT | cut -d ':' -f 2
 ///// ===========
+///// - What-if (-w) candidates with a bad process index or value are reported invalid in their slot instead of stopping the run
+///// - Dense states of 1..16 resources checked with width kernels generated at compile time (bankersLib.c FIXED_WIDTHS), generic kernels above
+///// - Added priority scheduler (-q), ready processes kept in a keyed heap during the worklist drain, weighted completion cost reported
+///// - Added --stats instrumentation (phase marks + library counters, compiled out with -DBANKER_STATS=0), STATS block or JSON line
+///// - Added headroom query (-m), maximum safe grant per process and resource (guided re-checks for one process, closure sweep per resource for all)
+///// - Added what-if mode (-w), candidate requests evaluated in one pass over the baseline sequence, only unproven ones re-checked (on -j threads)
+///// - Added sparse state storage (-z), only non-zero need/alloc values kept and checked, picked automatically below 1 in 8 non-zero
+///// - Moved readers/writers into bankersIO (shared with bankersBench workload generator + phase timing harness)
+///// - Moved state + algorithm into bankersLib (opaque bankerState, one arena allocation per state), CLI rebuilt on it. Replaces PTR_ALLOC_RES
+///// - Added output modes (-o), all results go through one 1MB buffered writer instead of printf per value
+///// - Added threaded safety check (-j), per-thread shares merged in index order so output never depends on thread timing
+///// - Added SSE2/AVX2 row kernels (runtime dispatch, scalar fallback), 2d rows padded to 8 ints and 32 byte aligned
+///// - Added v1 binary snapshot format (64 byte aligned little-endian blocks, need precomputed), used in place from mmap
+///// - Replaced fscanf input with mmap (or 1MB block) reader + hand-written int scanner, bad values reported with line/column
+///// - Added batch mode (-b), arrays are reused between snapshots when their dimensions fit
+///// - Added persistent request/release mode (-i), requests only re-verify the safe sequence prefix before the requesting process
+///// - Replaced O(n^2*m) rescan loop with worklist safety check (per-process unsatisfied counts + per-resource sorted needs)
 ///// - Fixed header parsing not leaving good state for next parser
 ///// - Added 'OUTPUT : ' prefix to all 'standard' program outputs for consistency. Grep for 'OUTPUT'/'INFO'/'ERROR' for easier sorting. 
 ///// - In future versions, use struct/class to store system state for more managable useage
 #include <stdio.h>
 #include <stdlib.h>
-
-#define MAX_PTR_ALLOCS_COUNT 8
-#define FILES_USED 1
-
-int *PTR_ALLOC_RES[MAX_PTR_ALLOCS_COUNT] = {0}; // Global array to store pointers used in program
-
-int allocInit2dIntArray(int,int,int,int**,int,int); // Allocates 2d array. Params: rows,cols,initValue,globalResources,globalResourceCount,globalFilesUsed. Returns index to globalResources array (resolve type when calling ptr)
-int allocInit1dIntArray(int,int,int**,int,int); // Allocates 1d array. Params: cols,initValue,globalResources,globalResourceCount,globalFilesUsed. Returns index to globalResources array 
-void skipReadLine(FILE*); // Skips forward 1 line in file. Takes: file ptr (from fopen(...))
-int readTabSep2dArray(FILE*,int**,int,int); // Reads tab-separated 2d array of known size. Params: file ptr,outputArray,rows,cols. Returns invalidReadFlag (0 if success,-1 if fail)
-int readTabSep1dArray(FILE*,int*,int); // Reads tab-separated 1d array of known size. Params: file ptr,outputArray,cols. Returns invalidReadFlag (0 if success, -1 if fail)
-int subtract2dArrays(int**,int**,int**,int,int); // Subtracts 2 arrays (1st array - 2nd array) and stores result in output array of known size. Params: outputArray,firstArray,secondArray,rows,cols. Returns resultsNegative (0 if all values in array positive, -1 if not)
-void cleanupAllocs(int**,int,int,int); // Cleans up any allocated memory stored in array of ptrs. Params: globalResources,globalResourceCount,globalFilesUsed,toDealloc(-1 if all)
-void copy1dArray(int*,int*,int); // Copys values from 1d array into another. Params: resultArray,sourceArray,cols
-void printCurrentState(int**,int**,int**,int*,int,int,int); // Prints out state of system stored in multiple arrays. Params: maxAllocatable,isAllocated,needsAllocation,availableResources,rows,cols,highlightProccess(-1 if none)
+#include <string.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <sys/resource.h>
+#include "bankersLib.h"
+#include "bankersIO.h"
+
+outputWriter OUTPUT_WRITER; // Writer for all OUTPUT results (file set to stdout in main)
+int SHOW_INFO = 1; // 0 if INFO lines are hidden (untagged output modes)
+int SAFETY_THREADS = 1; // Worker threads for safety checks of every state (-j)
+int STATE_FLAGS = 0; // BANKER_* flags of every state (from -p, -j/-s, -n)
+int *SCHEDULE_VALUES = NULL; // -q: priority | weight | keys (rows each), freed by exitCleanup
+const char *STATS_PHASE_NAMES[STATS_PHASES] = {"open","header","setup","alloc","max","avail","need","check","output"}; // --stats names of STATS_* phases
+
+void printInfo(const char*,...); // printf for INFO lines, skipped when SHOW_INFO is 0 (flushes OUTPUT_WRITER first to keep line order). Params: format,values
+int runRequestStream(bankerState**); // Reads REQUEST/RELEASE/ADD/QUERY/QUIT commands from stdin against loaded state (bankerCheck already run). Takes: state (replaced by a larger one when ADD needs rows). Returns exit code
+int runBatch(char**,int,int); // Evaluates every snapshot in every input (back-to-back snapshots per file allowed), one verdict line each. Params: inputPaths,inputCount,outputMode. Returns exit code
+int runConvert(char*,char*); // Converts every snapshot of input between text and binary (direction from input). Params: inputPath,outputPath. Returns exit code
+int exitCleanup(inputReader*,bankerState*,int); // Closes reader, destroys state and frees SCHEDULE_VALUES. Params: reader,state(NULL ok),exitCode. Returns exitCode
+bankerState *createCliState(int,int,int); // bankerCreate with command line flags/threads. Params: rowCapacity,colCapacity,extraFlags(eg. BANKER_VIEW_ONLY). Returns state (NULL if alloc failed)
+int runWhatIf(bankerState*,const char*,int); // Reads candidate requests from file, evaluates all against loaded state (bankerCheck already run), writes grant bitmap. Params: state,candidatePath,outputMode. Returns exit code
+int runHeadroom(bankerState*,const char*,int); // Computes maximum safe grant per resource for one process or all (bankerCheck already run), writes headroom rows. Params: state,processText('all', 'Pi' or i),outputMode. Returns exit code
+int setSchedule(bankerState*,inputReader*,const char*,int); // Reads optional priority section (text input), sets ready keys of state for scheduler order. Params: state,reader(NULL if binary),orderName,rows. Returns 0 if success, 1 if section malformed or alloc failed
+void writeScheduleCost(int,const int*,int,int); // Writes weighted completion cost of safe sequence (sum of weight x 1-based position). Params: outputMode,order,queued,rows
+void printStats(bankerState*,int,int,long long); // Writes --stats block (tagged modes, stdout) or JSON line (stderr for untagged modes, results stay parseable). Params: state,statsMode(1 block, 2 JSON),outputMode,bytesParsed
+int parseCommandVector(char*,int*,int,int*); // Parses 'Pi v1 v2 ...' from command line remainder. Params: text,outputVector,cols,outputProcess. Returns 0 if success, 1 if malformed
 
 
 
 int main(int argc, char *argv[]) {
-    printf("INFO : Bankers Algo version 1.2.3\n");
-    
-    //// Open file + read header
-    FILE *inputFile = fopen(argv[argc-1], "r");
-    if (inputFile == NULL) { // If file could not be opened, exit
-        printf("ERROR : File (%s) does not exist or cannot be opened.\n",argv[argc-1]); 
-        return 1;
+    //// Parse options (any argument starting with '-'), input file is the last non-option argument
+    int basicPriority = 0; // 1 if lowest index ready process is always queued first (original ordering)
+    int streamMode = 0; // 1 if commands are read from stdin after loading state (see runRequestStream)
+    int batchMode = 0; // 1 if every snapshot of every input is evaluated (see runBatch)
+    int convertMode = 0; // 1 if input is converted between text and binary formats (see runConvert)
+    int narrowLanes = 0; // 1 if stream mode keeps 16-bit copies of need/alloc (when all values fit)
+    char *kernelName = "auto"; // Row kernel set, see bankerSelectKernels
+    char *threadText = NULL; // Safety check threads (-j), NULL if single-threaded serial order
+    int serialOrder = 0; // 1 if -j keeps the serial (queue) order instead of rounds
+    char *outputName = "full"; // Output mode, see parseOutputMode
+    char *storageName = "auto"; // State storage, see parseStorageMode
+    char *whatIfPath = NULL; // Candidate requests file (-w), NULL if not in what-if mode
+    char *headroomText = NULL; // Process of headroom query (-m), NULL if not in headroom mode
+    char *scheduleName = NULL; // Ready process order (-q): priority, weight, shortest. NULL for index/FIFO order
+    int statsMode = 0; // 1 for STATS block, 2 for JSON line (--stats, --stats=json), 0 if off
+    char *inputPath = argv[argc-1]; // Defaults to last argument
+    int inputCount = 0; // Non-option arguments, compacted to front of argv (after argv[0]) for batch mode
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i],"-p") == 0) { basicPriority = 1; } // Basic process queuing priority (P0 before P1 ...)
+        else if (strcmp(argv[i],"-i") == 0) { streamMode = 1; } // Keep state loaded, read REQUEST/RELEASE/ADD commands from stdin
+        else if (strcmp(argv[i],"-b") == 0) { batchMode = 1; } // Evaluate all inputs, one verdict line per snapshot
+        else if (strcmp(argv[i],"-n") == 0) { narrowLanes = 1; } // 16-bit lanes for stream re-checks when values fit
+        else if (strcmp(argv[i],"-k") == 0 && i+1 < argc) { kernelName = argv[++i]; } // Row kernel set (auto, scalar, sse2, avx2)
+        else if (strcmp(argv[i],"-j") == 0 && i+1 < argc) { threadText = argv[++i]; } // Threads for safety checks
+        else if (strcmp(argv[i],"-s") == 0) { serialOrder = 1; } // With -j, report same sequence as single-threaded run
+        else if (strcmp(argv[i],"-o") == 0 && i+1 < argc) { outputName = argv[++i]; } // Output mode (full, diff, sequence, verdict, json, csv)
+        else if (strcmp(argv[i],"-c") == 0) { convertMode = 1; } // Convert first input (text <-> binary) into second
+        else if (strcmp(argv[i],"-z") == 0 && i+1 < argc) { storageName = argv[++i]; } // Need/alloc storage (auto, dense, sparse)
+        else if (strcmp(argv[i],"-w") == 0 && i+1 < argc) { whatIfPath = argv[++i]; } // Evaluate candidate requests against state
+        else if (strcmp(argv[i],"-m") == 0 && i+1 < argc) { headroomText = argv[++i]; } // Maximum safe grants of process (or all)
+        else if (strcmp(argv[i],"-q") == 0 && i+1 < argc) { scheduleName = argv[++i]; } // Priority/weight/shortest-need scheduler
+        else if (strcmp(argv[i],"--stats") == 0) { statsMode = 1; } // Phase times + counters after result
+        else if (strcmp(argv[i],"--stats=json") == 0) { statsMode = 2; }
+        else if (argv[i][0] == '-' && argv[i][1] != '\0') { argv[1+inputCount++] = argv[i]; } // Kept with inputs, reported once output mode is known
+        else { inputPath = argv[i]; argv[1+inputCount++] = argv[i]; } // Last non-option argument is used as input ('-' is stdin in batch mode)
     }
-    PTR_ALLOC_RES[0] = (int*)inputFile; // Store file ptr as int ptr in first index (within known file ptrs)
-    printf("INFO : Opened file (%s) for reading...\n",argv[argc-1]);
-
-    // Parse header information, and store for allocation of arrays (done without dynamic arrays for simplicity)
-    int resCount = 0; 
-    int procCount = 0;
-    fscanf(inputFile,"%d %d",&procCount,&resCount); // Header stored as process count, resource count + eats newline (for consistency)
-    if (resCount <= 0 | procCount <= 0) { // If any invalid values are read from header, exit 
-        printf("ERROR : File (%s) has an invalid header format. Cannot continue.\n",argv[argc-1]); 
-        cleanupAllocs(PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED,-1); 
-        return 1; 
-    }
-    char tempChar = fgetc(inputFile); // Skip past newline for parsing to continue
-    printf("INFO : File (%s) has valid header: Rows/Proccess=%i, Cols/Resources=%i\n",argv[argc-1],procCount,resCount);
-
-
-
-    //// Allocate arrays - if any allocations fail, exit gracefully
-    // Allocate 'currently allocated resources' array
-    int targetPtr = allocInit2dIntArray(procCount,resCount,0,PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED); // Attempts to allocate array
-    if (targetPtr == -1) { // Checks if allocation succeeded
-        printf("ERROR : Could not allocate %i x %i array for input (for currently used resources).\n",resCount,procCount);
-        cleanupAllocs(PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED,-1); // Deallocate all currently allocated resources
-        return 1;
+    int outputMode = parseOutputMode(outputName);
+    OUTPUT_WRITER.file = stdout;
+    SHOW_INFO = (outputMode == OUTPUT_FULL || outputMode == OUTPUT_DIFF); // Untagged modes only print results (and errors)
+    printInfo("INFO : Bankers Algo version 1.19.4\n");
+    int keptCount = 0;
+    for (int i = 1; i <= inputCount; ++i) { // Report unknown options, compact them out of inputs
+        if (argv[i][0] == '-' && argv[i][1] != '\0') { printInfo("INFO : Ignoring unknown option (%s).\n",argv[i]); }
+        else { argv[1+keptCount++] = argv[i]; }
     }
-    int **procAlloc = (int**)PTR_ALLOC_RES[targetPtr]; // Stores allocated 2d ptr (from global resource array)
-    
-    // Allocate 'maximum allocatable resources' array
-    targetPtr = allocInit2dIntArray(procCount,resCount,0,PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED); // Attempts to allocate array
-    if (targetPtr == -1) { // Checks if allocation succeeded
-        printf("ERROR : Could not allocate %i x %i array for input (for maximum usable resources).\n",resCount,procCount);
-        cleanupAllocs(PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED,-1); // Deallocate all currently allocated resources
+    inputCount = keptCount;
+    if (outputMode == -1) {
+        printf("ERROR : Output mode (%s) unknown (full, diff, sequence, verdict, json, csv).\n",outputName);
         return 1;
     }
-    int **maxAlloc = (int**)PTR_ALLOC_RES[targetPtr]; // Stores allocated 2d ptr (from global resource array)
-    
-    // Allocate 'needed resources' array
-    targetPtr = allocInit2dIntArray(procCount,resCount,0,PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED); // Attempts to allocate array
-    if (targetPtr == -1) { // Checks if allocation succeeded
-        printf("ERROR : Could not allocate %i x %i array for input (for needed resources).\n",resCount,procCount);
-        cleanupAllocs(PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED,-1); // Deallocate all currently allocated resources
+    int storageMode = parseStorageMode(storageName);
+    if (storageMode == -1) {
+        printf("ERROR : Storage (%s) unknown (auto, dense, sparse).\n",storageName);
         return 1;
     }
-    int **needAlloc = (int**)PTR_ALLOC_RES[targetPtr]; // Stores allocated 2d ptr (from global resource array)
-    
-    // Allocate 'available resources' array
-    targetPtr = allocInit1dIntArray(procCount,0,PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED); // Attempts to allocate array
-    if (targetPtr == -1) { // Checks if allocation succeeded
-        printf("ERROR : Could not allocate 1 x %i array for input (for available resources).\n",resCount);
-        cleanupAllocs(PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED,-1); // Deallocate all currently allocated resources
-        return 1;
+    if (storageMode != STORAGE_DENSE && !streamMode && whatIfPath == NULL && headroomText == NULL && (outputMode == OUTPUT_FULL || outputMode == OUTPUT_DIFF)) { // Tables print every value anyway, and need row ptrs
+        if (storageMode == STORAGE_SPARSE) { printInfo("INFO : Output mode %s prints full tables, using dense storage.\n",outputName); }
+        storageMode = STORAGE_DENSE;
     }
-    int *availRes = PTR_ALLOC_RES[targetPtr]; // Stores allocated 1d ptr (from global resource array)
-
-
-
-    //// Parse data into file (tab separated, but shouldn't matter for fscanf)
-    skipReadLine(inputFile); // Ignore 1 line of file - after header (no data stored)
-
-    // Read allocated resources array
-    if (readTabSep2dArray(inputFile,procAlloc,procCount,resCount)) { // Read data from file into array, if reads failed, exit.
-        printf("ERROR : Invalid read of currently allocated resources from file.\n");
-        cleanupAllocs(PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED,-1); // Deallocate all currently allocated resources
+    if (scheduleName != NULL && strcmp(scheduleName,"priority") != 0 && strcmp(scheduleName,"weight") != 0 && strcmp(scheduleName,"shortest") != 0) {
+        printf("ERROR : Scheduler order (%s) unknown (priority, weight, shortest).\n",scheduleName);
         return 1;
     }
-    skipReadLine(inputFile); // Ignore 1 line of file - after array
-
-    // Read maximum allocatable resources array
-    if (readTabSep2dArray(inputFile,maxAlloc,procCount,resCount)) { // Read data from file into array, if reads failed, exit.
-        printf("ERROR : Invalid read of currently allocated resources from file.\n");
-        cleanupAllocs(PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED,-1); // Deallocate all currently allocated resources
-        return 1;
+    if (scheduleName != NULL && (batchMode || convertMode)) { // Back-to-back snapshots have no room for a section
+        printInfo("INFO : Ignoring -q, batch and convert modes use the default order.\n");
+        scheduleName = NULL;
     }
-    skipReadLine(inputFile); // Ignore 1 line of file - after array
-
-    // Read available resources array
-    if (readTabSep1dArray(inputFile,availRes,resCount)) { // Attempt to read available resources array, should be final entry in file
-        printf("ERROR : Invalid read of available resources from file.\n");
-        cleanupAllocs(PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED,-1); // Deallocate all currently allocated resources
+    if (bankerSelectKernels(kernelName)) { // Unknown, or not supported by this cpu
+        printf("ERROR : Row kernels (%s) unknown or not supported by this cpu (auto, scalar, sse2, avx2).\n",kernelName);
         return 1;
     }
-    cleanupAllocs(PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED,0); // Deallocate ONLY opened file (no longer needed)
-
-    // Set up 'needed' array
-    if (subtract2dArrays(needAlloc,maxAlloc,procAlloc,procCount,resCount)) { // Subtract procAlloc from maxAlloc, check for any negative values and store in needAlloc
-        printf("ERROR : Invalid result for needed resource array calculation.\n");
-        cleanupAllocs(PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED,-1); // Deallocate all currently allocated resources
-        return 1;
+    if (threadText != NULL) { // Rounds order is used for every -j value (so 1..N threads give one sequence), unless serial order requested
+        char *end;
+        long threads = strtol(threadText,&end,10);
+        if (*end != '\0' || threads < 1 || threads > BANKER_MAX_THREADS) {
+            printf("ERROR : Thread count (%s) must be 1 to %d.\n",threadText,BANKER_MAX_THREADS);
+            return 1;
+        }
+        SAFETY_THREADS = (int)threads;
+        if (!(serialOrder || basicPriority || scheduleName != NULL)) { STATE_FLAGS |= BANKER_ROUNDS; }
+        printInfo("INFO : Safety checks use up to %d thread(s), %s order.\n",SAFETY_THREADS,(STATE_FLAGS & BANKER_ROUNDS) ? "rounds" : "serial");
+    }
+    if (basicPriority) { STATE_FLAGS |= BANKER_LOWEST_FIRST; }
+    if (scheduleName != NULL) { STATE_FLAGS |= BANKER_PRIORITY; } // Ties still go to the lowest index
+    if (narrowLanes && streamMode) { STATE_FLAGS |= BANKER_NARROW; } // Only request re-checks use 16-bit copies
+    if (statsMode && (convertMode || batchMode)) { // Phases are per snapshot, only the single-input path marks them
+        printInfo("INFO : Ignoring --stats, only single-input runs are instrumented.\n");
+        statsMode = 0;
+    }
+#if !BANKER_STATS
+    if (statsMode) { printInfo("INFO : Ignoring --stats, built with BANKER_STATS=0.\n"); }
+    statsMode = 0;
+#else
+    if (statsMode) { statsStart(); } // Marks below only record once started
+#endif
+    if (convertMode) { // Converter handles its own files and states
+        if (inputCount != 2) { printf("ERROR : Convert mode needs an input and an output file (-c IN OUT).\n"); return 1; }
+        return runConvert(argv[1],argv[2]);
+    }
+    if (batchMode) { // Batch mode handles its own files and state
+        if (inputCount == 0) { printf("ERROR : No input files given for batch mode.\n"); return 1; }
+        return runBatch(argv+1,inputCount,outputMode);
+    }
+    for (int i = 0; i < inputCount-1; ++i) { // Only one input is evaluated outside of batch mode
+        printInfo("INFO : Ignoring input (%s), pass -b to evaluate every input.\n",argv[1+i]);
     }
 
-
-
-    //// Bankers algorithm implementation (Processes queued earlier if position in table is higher)
-    // Allocate 1d array for proccesses' queue status (0 if not in queue, 1 if is in queue)
-    targetPtr = allocInit1dIntArray(procCount,0,PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED); // Attempts to allocate 1d array
-    if (targetPtr == -1) { // Checks if allocation succeeded
-        printf("ERROR : Unable to allocate array1 for Banker's algorithm. \n");
-        cleanupAllocs(PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED,-1); 
-        return 1; 
-    } // If allocation fails, exit
-    int *procCheck = PTR_ALLOC_RES[targetPtr]; // Stores allocated 1d ptr (from global resource array)
-
-    // Allocate 1d array for to-execute queue
-    targetPtr = allocInit1dIntArray(procCount,-1,PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED); // Attempts to allocate 1d array
-    if (targetPtr == -1) { // Checks if allocation succeeded
-        printf("ERROR : Unable to allocate array2 for Banker's algorithm. \n");
-        cleanupAllocs(PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED,-1); 
-        return 1; 
-    } // If allocation fails, exit
-    int *procOrder = PTR_ALLOC_RES[targetPtr]; // Stores allocated 1d ptr (from global resource array)
-
-    // Allocate 1d Array for temporary processing + copy 
-    targetPtr = allocInit1dIntArray(resCount,0,PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED); // Attempts to allocate 1d array
-    if (targetPtr == -1) { // Checks if allocation succeeded
-        printf("ERROR : Unable to allocate array for copy of available resource array. \n");
-        cleanupAllocs(PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED,-1);
+    //// Open file + read header
+    inputReader inputFile; // Mapped (or block-read) input, closed by exitCleanup
+    if (openInputReader(&inputFile,inputPath)) { // If file could not be opened, exit
+        printf("ERROR : File (%s) does not exist or cannot be opened.\n",inputPath); 
         return 1;
-    } // If allocation fails, exit 
-    int *availCopy = PTR_ALLOC_RES[targetPtr]; // Stores allocated 1d ptr (from global resource array)
-    copy1dArray(availCopy,availRes,resCount); // Copy array to be used for test-operations (to allow for step-by-step state output later)
-
-
-
-
-    // Bankers Algo, exits immediately if system is in unsafe state and cannot queue any processes, preventing unneeded itterations
-    //     Due to how algorithm is implemented here, proccesses with lower indexes (P0,P1,...) will be 
-    //     queued before processes with higher indexes (P100,P99,...), thus adding a basic 'process queuing priority'.
-    //     Not required by project description, however kept for possible use cases. 
-    //         - Moving rows/Changing proccess order has very little overhead in the 2d arrays due to the per-row ptr
-    //           implementation for them. Eg: Swapping queuing priority of proccess i with proccess j - 
-    /*
-        int *tempRowPtr = array[i]; 
-        array[i] = array[j];
-        array[j] = tempRowPtr;
-    */
-    for (int i = 0; i < procCount; ++i) { // For each 'target' position in queue
-        for (int j = 0; j < procCount; ++j) { // For each possible process FOR a position in queue
-            if (procCheck[j] == 0) { // If process CAN be selected, check if enough available resources exist
-                // If no needed resources > than available, ...
-                int canBeQueued = 1; 
-                for (int k = 0; k < resCount; ++k) { // Check if any resource needs exceeds available resources
-                    if (needAlloc[j][k] > availCopy[k]) { canBeQueued = 0; break; } 
-                }
-
-                // ..., queue proccess.
-                if (canBeQueued) { 
-                    procOrder[i] = j; // Proccess 'j' has passed tests, and can be added to queue (in pos i)
-                    for (int k = 0; k < resCount; ++k) {
-                        availCopy[k] += procAlloc[j][k]; // Increases available resources, as selected process will have completed before queue proceeds
-                    }
-                    procCheck[j] = 1; // Flag process as checked
+    }
+    STATS_MARK(STATS_OPEN);
+    printInfo("INFO : Opened file (%s) for reading...\n",inputPath);
 
-                    break; // Exits out of process checking, and selects next i to check for
-                }
-            }
+    // Parse header information, then load system state (one arena allocation holds every array, see bankersLib.h)
+    int resCount = 0; 
+    int procCount = 0;
+    bankerState *state = NULL; // Owns all matrices + safety-check scratch
+    int binaryInput = readerIsBinary(&inputFile); // Binary records have no priority section
+    int checkInPlace = 0; // 1 if binary record is checked on the mapping (bankerCheckView), only for runs that never change the state
+    binaryView view; // Blocks of mapped binary record, mapping stays open until exitCleanup when checked in place
+    if (binaryInput) { // Binary snapshot, need block verified first (it is used as stored)
+        if (mapBinarySnapshot(&inputFile,&view)) {
+            printf("ERROR : File (%s) is not a valid v%i binary snapshot%s. Cannot continue.\n",inputPath,BINARY_VERSION,hostIsLittleEndian() ? "" : " (big-endian host)");
+            return exitCleanup(&inputFile,state,1);
+        }
+        procCount = view.rowCount;
+        resCount = view.colCount;
+        checkInPlace = (!streamMode && whatIfPath == NULL && headroomText == NULL && scheduleName == NULL); // -i/-w/-m/-q need a loaded state, record copied in
+        STATS_MARK(STATS_HEADER);
+        printInfo("INFO : File (%s) is a binary snapshot: Rows/Proccess=%i, Cols/Resources=%i\n",inputPath,procCount,resCount);
+        state = createCliState(procCount,resCount,checkInPlace ? BANKER_VIEW_ONLY : 0); // View-only state holds scratch, no matrices (files larger than RAM work)
+        if (state == NULL) {
+            printf("ERROR : Could not allocate %i x %i state for input.\n",procCount,resCount);
+            return exitCleanup(&inputFile,state,1);
+        }
+        STATS_MARK(STATS_SETUP);
+        int badRow = 0;
+        int needResult = checkBinaryNeed(&view,&badRow);
+        if (needResult == BINARY_NEED_NEGATIVE) {
+            printf("ERROR : Invalid result for needed resource array calculation.\n");
+            return exitCleanup(&inputFile,state,1);
+        }
+        if (needResult == BINARY_NEED_MISMATCH) {
+            printf("ERROR : File (%s) stores a need row for P%i that is not maximum - allocated. Cannot continue.\n",inputPath,badRow);
+            return exitCleanup(&inputFile,state,1);
+        }
+        if (!checkInPlace && bankerLoad(state,procCount,resCount,view.alloc,view.max,view.avail,view.rowStride) != BANKER_OK) {
+            printf("ERROR : Invalid result for needed resource array calculation.\n");
+            return exitCleanup(&inputFile,state,1);
+        }
+    } else {
+        int headerRead = readerNextInt(&inputFile,&procCount); // Header stored as process count, resource count
+        if (headerRead == READ_OK) { headerRead = readerNextInt(&inputFile,&resCount); }
+        if (headerRead != READ_OK || resCount <= 0 || procCount <= 0) { // If any invalid values are read from header, exit 
+            printf("ERROR : File (%s) has an invalid header format. Cannot continue.\n",inputPath); 
+            return exitCleanup(&inputFile,state,1);
+        }
+        skipReadLine(&inputFile); // Skip past newline for parsing to continue
+        STATS_MARK(STATS_HEADER);
+        printInfo("INFO : File (%s) has valid header: Rows/Proccess=%i, Cols/Resources=%i\n",inputPath,procCount,resCount);
+
+        //// Allocate state (dense or sparse) and parse data straight into it (tab separated, but any whitespace accepted by scanner) - if allocation fails, exit gracefully
+        int readResult = 0;
+        state = loadTextState(&inputFile,procCount,resCount,STATE_FLAGS,storageMode,&readResult); // Comment line + array, 3 times
+        if (state == NULL) {
+            printf("ERROR : Could not allocate %i x %i state for input.\n",procCount,resCount);
+            return exitCleanup(&inputFile,state,1);
+        }
+        bankerSetThreads(state,SAFETY_THREADS);
+        if (readResult == 4) { // Only possible for forced sparse storage of unmapped input
+            printf("ERROR : Too many non-zero values for sparse storage, use -z dense.\n");
+            return exitCleanup(&inputFile,state,1);
+        }
+        if (readResult) { // Which array failed is returned, exit
+            const char *arrayName = (readResult == 1) ? "currently allocated" : ((readResult == 2) ? "maximum allocatable" : "available");
+            printf("ERROR : Invalid read of %s resources from file (line %li, column %li: %s).\n",arrayName,inputFile.errorLine,inputFile.errorColumn,readerErrorText(inputFile.errorKind));
+            return exitCleanup(&inputFile,state,1);
         }
 
-        if (procOrder[i] == -1) { // All processes were checked for ith position in queue, and none could be queued.
-            printf("OUTPUT : Initial System State:\n");
-            printCurrentState(maxAlloc,procAlloc,needAlloc,availRes,procCount,resCount,-1); // Output system current state
-            
-            printf("OUTPUT : System is not in a safe state.\n");
-            cleanupAllocs(PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED,-1); // Deallocate all currently allocated resources
-            return 0;
+        // Set up 'needed' array (need = max - alloc, computed by bankerEndLoad)
+        if (bankerEndLoad(state) != BANKER_OK) { // Allocated above maximum somewhere
+            printf("ERROR : Invalid result for needed resource array calculation.\n");
+            return exitCleanup(&inputFile,state,1);
         }
+        if (bankerIsSparse(state)) { printInfo("INFO : Using sparse storage (%i non-zero maximum values of %lli).\n",bankerEntries(state),(long long)procCount*resCount); }
+    }
+    if (scheduleName != NULL && setSchedule(state,binaryInput ? NULL : &inputFile,scheduleName,procCount)) {
+        printf("ERROR : Invalid read of priority section from file (line %li, column %li: %s).\n",inputFile.errorLine,inputFile.errorColumn,readerErrorText(inputFile.errorKind));
+        return exitCleanup(&inputFile,state,1);
+    }
+    STATS_MARK(STATS_NEED); // Binary need verified (+ copy), or text need
+    long long bytesParsed = (long long)(inputFile.base + inputFile.pos); // Header + arrays (whole record for binary)
+    if (!checkInPlace) { // State holds its own copy, file no longer needed
+        closeInputReader(&inputFile);
+        STATS_MARK(STATS_OPEN); // Unmap counted with open
     }
 
 
 
-    //// Output safe sequence results (unsafe result would have returned already)
-    printf("OUTPUT : Initial System State:\n");
-    printCurrentState(maxAlloc,procAlloc,needAlloc,availRes,procCount,resCount,-1); // Output system current state
-
-    for (int i = 0; i < procCount; ++i) { // Updates states based on queue: display state first (with queued proccess selected), and THEN update values
-        printf("OUTPUT : Exec %i, System state:\n",i+1); // Output 'real' execution order
-        printCurrentState(maxAlloc,procAlloc,needAlloc,availRes,procCount,resCount,procOrder[i]); // Output system current state (pre-update)
-        
-        for (int j = 0; j < resCount; ++j) { // Updating values in arrays
-            availRes[j] += procAlloc[procOrder[i]][j]; // Updates the avail-resources for proccess which is in the ith position in queue
-            procAlloc[procOrder[i]][j] = 0; // Sets the new 'currently' allocated resources to 0
-            needAlloc[procOrder[i]][j] = 0; // No longer needs any allocated resources, process has completed
-            maxAlloc[procOrder[i]][j] = 0; // Process no longer running, thus dropped
-        }
-    }
-    printf("OUTPUT : Final System State:\n");
-    printCurrentState(maxAlloc,procAlloc,needAlloc,availRes,procCount,resCount,-1); // Final system state displayed (available resources updated, all other processes zeroed)
-    //printf("\n");    
-
-
-
-    // Outputs safe sequence summary for system state 
-    printf("OUTPUT : Safe sequence displayed:\n");
-    printf("OUTPUT : "); // printf 'tag' for sorting of program output
-    for (int i = 0; i < procCount-1; ++i) {
-        printf("P%i > ",procOrder[i]);
+    //// Bankers algorithm implementation (Processes queued earlier if position in table is higher, when basic priority used)
+    // Bankers Algo (worklist form, see bankersLib.c), each (process,resource) pair is only re-checked when that resource grows past its need.
+    //     With basicPriority set, the ready process with the lowest index (P0,P1,...) is always queued first, which
+    //     gives the same sequence as the original 'rescan from P0' loop (basic 'process queuing priority').
+    //     Otherwise ready processes are queued in the order they became ready (FIFO), which skips the heap upkeep.
+    int queuedCount = checkInPlace ? bankerCheckView(state,procCount,resCount,view.alloc,view.need,view.avail,view.rowStride) : bankerCheck(state); // Fills bankerOrder, returns amount of processes queued
+    STATS_MARK(STATS_CHECK);
+    if (streamMode) { // Persistent request/release mode, state stays loaded until end of input (or QUIT)
+        int streamResult = runRequestStream(&state);
+        STATS_MARK(STATS_OUTPUT);
+        if (statsMode) { printStats(state,statsMode,outputMode,bytesParsed); }
+        return exitCleanup(&inputFile,state,streamResult);
     }
-    printf("P%i\n",procOrder[procCount-1]);
-
-    //// Cleanup and exit. Algorithm succeeded
-    cleanupAllocs(PTR_ALLOC_RES,MAX_PTR_ALLOCS_COUNT,FILES_USED,-1); // Deallocate all currently allocated resources
-    return 0;
+    if (whatIfPath != NULL) { // Bitmap instead of sequence output
+        int whatIfResult = runWhatIf(state,whatIfPath,outputMode);
+        STATS_MARK(STATS_OUTPUT);
+        if (statsMode) { printStats(state,statsMode,outputMode,bytesParsed); }
+        return exitCleanup(&inputFile,state,whatIfResult);
+    }
+    if (headroomText != NULL) { // Headroom rows instead of sequence output
+        int headroomResult = runHeadroom(state,headroomText,outputMode);
+        STATS_MARK(STATS_OUTPUT);
+        if (statsMode) { printStats(state,statsMode,outputMode,bytesParsed); }
+        return exitCleanup(&inputFile,state,headroomResult);
+    }
+    //// Output results (safe sequence, or unsafe state) in selected mode
+    if (checkInPlace) { // Tables read the mapped rows (private mapping, so full/diff/csv may write them)
+        int **viewRows = NULL; // alloc | max | need row ptrs, only tables and csv (marks finished rows in need) use them
+        if ((outputMode == OUTPUT_FULL || outputMode == OUTPUT_DIFF || outputMode == OUTPUT_CSV) && (viewRows = binaryViewRows(&view)) == NULL) {
+            printf("ERROR : Could not allocate row arrays for binary input.\n");
+            return exitCleanup(&inputFile,state,1);
+        }
+        int **rowBlocks[3] = {NULL,NULL,NULL};
+        for (int i = 0; i < 3 && viewRows != NULL; ++i) { rowBlocks[i] = viewRows + (size_t)i*procCount; }
+        writeSnapshotResult(&OUTPUT_WRITER,outputMode,rowBlocks[1],rowBlocks[0],rowBlocks[2],view.avail,(int*)bankerFinalAvailable(state),procCount,resCount,(int*)bankerOrder(state),queuedCount);
+        free(viewRows);
+    } else { writeSnapshotResult(&OUTPUT_WRITER,outputMode,bankerMaxRows(state),bankerAllocRows(state),bankerNeedRows(state),bankerAvailable(state),(int*)bankerFinalAvailable(state),procCount,resCount,(int*)bankerOrder(state),queuedCount); }
+    if (scheduleName != NULL) { writeScheduleCost(outputMode,bankerOrder(state),queuedCount,procCount); }
+    writerFlush(&OUTPUT_WRITER);
+    STATS_MARK(STATS_OUTPUT);
+    if (statsMode) { printStats(state,statsMode,outputMode,bytesParsed); }
+
+    //// Cleanup and exit. Algorithm succeeded (unsafe is a valid result)
+    return exitCleanup(&inputFile,state,0);
 }
 
 
 
 //// Function definitions
-int allocInit2dIntArray(int rowCount,int colCount, int defaultVal, int **resources, int resourceCount, int filesUsed) { // Function to allocate and initialize 'true' 2d array. Access via name[i][j]. Returns index in resAlloc array that is passed. 
-    // Ensure non-zero allocation
-    if (rowCount <= 0 || colCount <= 0) { return -1; }
-    
-    // Allocate memory (if possible), otherwise exit. Handle error later
-    int arrayMemSize = sizeof(int *)*(rowCount) + sizeof(int)*(colCount)*(rowCount); // Size = row*col ints + row ptrs for access with 2 [] operators
-    int **new2dArray = (int **)malloc(arrayMemSize);
-    if (new2dArray == NULL) { return -1; } // If malloc fails do not attempt to access non-real addrs.
-
-    // Setup array + initialize
-    int *tempPtr = (int *)(new2dArray + rowCount); // Point to first element of (currently 1d) array
-    for (int i = 0; i < rowCount; ++i) { // Setup internal array ptrs
-        new2dArray[i] = (tempPtr + colCount*i); // Per-row offsets used
+void printInfo(const char *format, ...) {
+    if (!SHOW_INFO) { return; }
+    writerFlush(&OUTPUT_WRITER); // Results written so far come first
+    va_list values;
+    va_start(values,format);
+    vprintf(format,values);
+    va_end(values);
+}
+int runRequestStream(bankerState **statePtr) { // Long-lived request/release loop over loaded state. State passed by address as ADD may move it into a larger one
+    bankerState *state = *statePtr;
+    int colCount = bankerCols(state);
+    int lineLength = 16*colCount + 64; // Enough for 'REQUEST P<int>' plus cols values of up to 15 chars
+    int *request = (int*)malloc(sizeof(int)*(size_t)colCount); // Command vector and line buffer, only allocations of stream (state allocates nothing per command)
+    char *line = (char*)malloc((size_t)lineLength);
+    if (request == NULL || line == NULL) {
+        printf("ERROR : Unable to allocate arrays for request stream.\n");
+        free(request);
+        free(line);
+        return 1;
     }
-
-    for (int i = 0; i < rowCount; ++i) { // Per-row ...
-        for (int j = 0; j < colCount; ++j) { // Per-col ...
-            new2dArray[i][j] = defaultVal; // Initialize values to 0
+    static const char *denyText[] = {"","exceeds maximum claim","exceeds available","unsafe","exceeds allocated","exceeds total resources"}; // Indexed by BANKER_DENY_*
+
+    printInfo("INFO : Using %s lanes for request re-checks.\n",bankerUsesNarrow(state) ? "16-bit" : "32-bit");
+    printf("OUTPUT : Loaded %i processes, state is %s.\n",bankerRows(state),bankerIsSafe(state) ? "safe" : "not safe");
+    fflush(stdout); // Callers wait on each response line
+
+    while (fgets(line,lineLength,stdin) != NULL) {
+        if (strchr(line,'\n') == NULL && !feof(stdin)) { // Line longer than buffer, discard remainder
+            int c = 0;
+            do { c = fgetc(stdin); } while (c != '\n' && c != EOF);
+            printf("ERROR : Command too long, ignored.\n");
+            fflush(stdout);
+            continue;
+        }
+        char *cmd = line;
+        while (isspace((unsigned char)*cmd)) { ++cmd; } // Skip leading whitespace
+        if (*cmd == '\0') { continue; } // Blank line
+
+        int rowCount = bankerRows(state);
+        int proc = -1;
+        if (strncmp(cmd,"QUIT",4) == 0) { break; }
+        else if (strncmp(cmd,"QUERY",5) == 0) { // Outputs current safe sequence (re-checked fully if last known state was unsafe)
+            if (!bankerIsSafe(state)) { bankerCheck(state); }
+            if (!bankerIsSafe(state)) { printf("OUTPUT : UNSAFE\n"); } 
+            else {
+                const int *order = bankerOrder(state);
+                printf("OUTPUT : SAFE ");
+                for (int i = 0; i < rowCount-1; ++i) { printf("P%i > ",order[i]); }
+                printf("P%i\n",order[rowCount-1]);
+            }
+        }
+        else if (strncmp(cmd,"REQUEST ",8) == 0) { // Resource-request algorithm, only the safe sequence prefix before proc is re-verified
+            if (parseCommandVector(cmd+8,request,colCount,&proc) || proc >= rowCount) { printf("ERROR : Malformed command (%s).\n",strtok(cmd,"\n")); fflush(stdout); continue; }
+            int result = bankerRequest(state,proc,request);
+            if (result == BANKER_OK) { printf("OUTPUT : GRANT P%i\n",proc); }
+            else { printf("OUTPUT : DENY P%i (%s)\n",proc,denyText[result]); }
         }
+        else if (strncmp(cmd,"RELEASE ",8) == 0) { // Returned resources raise available and need equally, any old safe sequence stays safe
+            if (parseCommandVector(cmd+8,request,colCount,&proc) || proc >= rowCount) { printf("ERROR : Malformed command (%s).\n",strtok(cmd,"\n")); fflush(stdout); continue; }
+            int result = bankerRelease(state,proc,request);
+            if (result == BANKER_OK) { printf("OUTPUT : RELEASED P%i\n",proc); }
+            else { printf("OUTPUT : DENY P%i (%s)\n",proc,denyText[result]); }
+        }
+        else if (strncmp(cmd,"ADD ",4) == 0) { // New process with zero allocation, safe at end of sequence if max <= total resources
+            if (parseCommandVector(cmd+4,request,colCount,&proc) || proc != rowCount) { printf("ERROR : Malformed command (%s), ADD must use next process index P%i.\n",strtok(cmd,"\n"),rowCount); fflush(stdout); continue; }
+            int result = bankerAddProcess(state,request);
+            if (result == BANKER_FULL) { // Move into state with double the rows, old state kept if that fails
+                bankerState *grown = bankerIsSparse(state) ? bankerCreateSparse(2*bankerRowCapacity(state),bankerColCapacity(state),2*bankerEntries(state)+bankerColCapacity(state),bankerFlags(state))
+                                                           : bankerCreate(2*bankerRowCapacity(state),bankerColCapacity(state),bankerFlags(state));
+                if (grown == NULL) { printf("ERROR : Unable to grow arrays for P%i.\n",proc); fflush(stdout); continue; }
+                bankerSetThreads(grown,SAFETY_THREADS);
+                bankerCopy(grown,state);
+                bankerDestroy(state);
+                state = grown;
+                *statePtr = state;
+                result = bankerAddProcess(state,request);
+            }
+            if (result == BANKER_OK) { printf("OUTPUT : ADDED P%i\n",proc); }
+            else { printf("OUTPUT : DENY P%i (%s)\n",proc,denyText[result]); }
+        }
+        else { printf("ERROR : Unknown command (%s).\n",strtok(cmd,"\n")); }
+        fflush(stdout);
     }
-
-    // Store ptr in resources array for program to access
-    int posInResArr = -1;
-    for (int i = filesUsed; i < resourceCount; ++i) { // Find available position in array
-        if (resources[i] == NULL) { posInResArr = i; break; }
+    free(request);
+    free(line);
+    return 0;
+}
+int runWhatIf(bankerState *state, const char *candidatePath, int outputMode) { // Candidates are independent (none sees another's grant), so all share one baseline sequence
+    int rowCount = bankerRows(state);
+    int colCount = bankerCols(state);
+    FILE *candidateFile = fopen(candidatePath,"r");
+    if (candidateFile == NULL) {
+        printf("ERROR : Candidate file (%s) does not exist or cannot be opened.\n",candidatePath);
+        return 1;
+    }
+    int lineLength = 16*colCount + 64; // Same bound as stream commands
+    char *line = (char*)malloc((size_t)lineLength);
+    int capacity = 1024;
+    int count = 0;
+    int *procs = (int*)malloc(sizeof(int)*(size_t)capacity);
+    int *requests = (int*)malloc(sizeof(int)*(size_t)capacity*colCount); // Candidate i at i*colCount
+    int failed = (line == NULL || procs == NULL || requests == NULL);
+    long lineNumber = 0;
+    int invalid = 0; // Malformed candidates (bad process index or value)
+    while (!failed && fgets(line,lineLength,candidateFile) != NULL) {
+        ++lineNumber;
+        char *cmd = line;
+        while (isspace((unsigned char)*cmd)) { ++cmd; }
+        if (*cmd == '\0' || *cmd == '#') { continue; } // Blank line or comment
+        if (strncmp(cmd,"REQUEST ",8) == 0) { cmd += 8; } // Stream command files can be used as they are
+        if (count == capacity) { // Doubled, candidate lists are read once
+            int *grownProcs = (int*)realloc(procs,sizeof(int)*2*(size_t)capacity);
+            if (grownProcs != NULL) { procs = grownProcs; }
+            int *grownRequests = (grownProcs == NULL) ? NULL : (int*)realloc(requests,sizeof(int)*2*(size_t)capacity*colCount);
+            if (grownRequests != NULL) { requests = grownRequests; }
+            failed = (grownRequests == NULL);
+            if (failed) { break; }
+            capacity *= 2;
+        }
+        int tooLong = (strchr(cmd,'\n') == NULL && !feof(candidateFile)); // Longer than any valid line
+        if (tooLong) { // Discard remainder, so it is not read as another candidate
+            int c = 0;
+            do { c = fgetc(candidateFile); } while (c != '\n' && c != EOF);
+        }
+        if (tooLong || parseCommandVector(cmd,requests + (size_t)count*colCount,colCount,&procs[count]) || procs[count] >= rowCount) { // Kept in its slot, bankerWhatIf reports BANKER_INVALID for it
+            printInfo("INFO : Malformed candidate %i on line %li of (%s), expected 'P0..P%i' and %i values. Reported as invalid.\n",count,lineNumber,candidatePath,rowCount-1,colCount);
+            memset(requests + (size_t)count*colCount,0,sizeof(int)*(size_t)colCount);
+            procs[count] = -1;
+            ++invalid;
+        }
+        ++count;
     }
-    if (posInResArr == -1) { // Did not find position to store ptr in
-        free(new2dArray); // Free to prevent memory leak
-        return posInResArr; // Return -1 to indicate error
+    fclose(candidateFile);
+    unsigned char *grantBits = failed ? NULL : (unsigned char*)malloc((size_t)count/8+1);
+    int *results = failed ? NULL : (int*)malloc(sizeof(int)*((size_t)count+1));
+    size_t workspaceBytes = bankerWhatIfWorkspace(state,count);
+    void *workspace = failed ? NULL : malloc(workspaceBytes);
+    int proven = 0;
+    int granted = (grantBits == NULL || results == NULL || workspace == NULL) ? BANKER_INVALID : bankerWhatIf(state,count,procs,requests,colCount,grantBits,results,&proven,workspace,workspaceBytes);
+    free(workspace);
+    if (granted == BANKER_INVALID) {
+        printf("ERROR : Unable to allocate arrays for %i candidate requests.\n",count);
+        free(line);
+        free(procs);
+        free(requests);
+        free(grantBits);
+        free(results);
+        return 1;
     }
-
-    // Pass back initialized array
-    resources[posInResArr] = (int*)new2dArray; // Ensure correct ptr type stored, upto user to ensure correct type used when this is re-cast to original type (int**)
-    return posInResArr;
+    int rechecked = 0; // Passed the up-front checks, but not proven by the baseline sequence
+    for (int i = 0; i < count && bankerIsSafe(state); ++i) { rechecked += (results[i] == BANKER_OK || results[i] == BANKER_DENY_UNSAFE); }
+    printInfo("INFO : Read %i candidate request(s) (%i malformed), state is %s. %i proven safe by the baseline sequence, %i re-checked on up to %i thread(s).\n",count,invalid,bankerIsSafe(state) ? "safe" : "not safe",proven,rechecked - proven,SAFETY_THREADS);
+
+    //// Bitmap: one '1' (grant) or '0' (deny) per candidate, in file order
+    static const char *resultText[] = {"granted","exceeds maximum claim","exceeds available","unsafe"}; // Indexed by BANKER_OK/DENY_* (request results)
+    if (outputMode == OUTPUT_CSV) { // One row per candidate with reason
+        writerPutText(&OUTPUT_WRITER,"candidate,process,granted,result\n");
+        for (int i = 0; i < count; ++i) {
+            writerPutInt(&OUTPUT_WRITER,i);
+            writerPutText(&OUTPUT_WRITER,",");
+            writerPutInt(&OUTPUT_WRITER,procs[i]);
+            writerPutText(&OUTPUT_WRITER,(results[i] == BANKER_OK) ? ",1," : ",0,");
+            writerPutText(&OUTPUT_WRITER,(results[i] >= BANKER_OK && results[i] <= BANKER_DENY_UNSAFE) ? resultText[results[i]] : "invalid");
+            writerPutText(&OUTPUT_WRITER,"\n");
+        }
+    } else {
+        if (outputMode == OUTPUT_JSON) {
+            writerPutText(&OUTPUT_WRITER,bankerIsSafe(state) ? "{\"safe\":true,\"candidates\":" : "{\"safe\":false,\"candidates\":");
+            writerPutInt(&OUTPUT_WRITER,count);
+            writerPutText(&OUTPUT_WRITER,",\"granted\":");
+            writerPutInt(&OUTPUT_WRITER,granted);
+            writerPutText(&OUTPUT_WRITER,",\"bitmap\":\"");
+        } else if (outputMode == OUTPUT_FULL || outputMode == OUTPUT_DIFF) {
+            writerPutText(&OUTPUT_WRITER,"OUTPUT : ");
+            writerPutInt(&OUTPUT_WRITER,granted);
+            writerPutText(&OUTPUT_WRITER," of ");
+            writerPutInt(&OUTPUT_WRITER,count);
+            writerPutText(&OUTPUT_WRITER," candidate request(s) can be granted.\nOUTPUT : ");
+        }
+        for (int i = 0; i < count; ++i) { writerPutText(&OUTPUT_WRITER,(grantBits[i >> 3] & (1 << (i & 7))) ? "1" : "0"); }
+        writerPutText(&OUTPUT_WRITER,(outputMode == OUTPUT_JSON) ? "\"}\n" : "\n");
+    }
+    writerFlush(&OUTPUT_WRITER);
+    free(line);
+    free(procs);
+    free(requests);
+    free(grantBits);
+    free(results);
+    return 0;
 }
-int allocInit1dIntArray(int valCount, int defaultVal, int **resources, int resourceCount, int filesUsed) { // Function to allocate and initialize 1d arrays. Returns index in resAlloc array that is passed
-    // Ensure non-zero allocation
-    if (valCount <= 0) { return -1; }
-
-    // Allocate memory (if possible), otherwise exit. Handle error later
-    int *new1dArray = (int *)malloc(valCount*sizeof(int));
-    if (new1dArray == NULL) { return -1; } // If malloc fails do not attempt to access non-real addrs.
-
-    // Initialize + Return array
-    for (int i = 0; i < valCount; ++i) {
-        new1dArray[i] = defaultVal;
+int runHeadroom(bankerState *state, const char *processText, int outputMode) { // Rows can be cached by callers until the next grant/release/add (bankerOrderVersion does not cover those)
+    int rowCount = bankerRows(state);
+    int colCount = bankerCols(state);
+    int proc = -1; // All processes
+    if (strcmp(processText,"all") != 0) {
+        char *end;
+        long value = strtol(processText + (processText[0] == 'P'),&end,10);
+        if (*end != '\0' || end == processText + (processText[0] == 'P') || value < 0 || value >= rowCount) {
+            printf("ERROR : Headroom process (%s) must be 'all' or P0..P%i.\n",processText,rowCount-1);
+            return 1;
+        }
+        proc = (int)value;
     }
-    
-    // Store ptr in resources array for program to access
-    int posInResArr = -1;
-    for (int i = filesUsed; i < resourceCount; ++i) { // Find available position in array
-        if (resources[i] == NULL) { posInResArr = i; break; }
+    int firstProc = (proc < 0) ? 0 : proc;
+    int headroomRows = (proc < 0) ? rowCount : 1;
+    int *headroom = (int*)malloc(sizeof(int)*(size_t)headroomRows*colCount);
+    size_t workspaceBytes = bankerHeadroomWorkspace(state,proc);
+    void *workspace = malloc(workspaceBytes);
+    int result = (headroom == NULL || workspace == NULL) ? BANKER_INVALID : bankerHeadroom(state,proc,headroom,workspace,workspaceBytes);
+    free(workspace);
+    if (result == BANKER_INVALID) {
+        printf("ERROR : Unable to allocate arrays for %i x %i headroom.\n",headroomRows,colCount);
+        free(headroom);
+        return 1;
     }
-    if (posInResArr == -1) { // Did not find position to store ptr in
-        free(new1dArray); // Free to prevent memory leak
-        return posInResArr; // Return -1 to indicate error
+    printInfo("INFO : State is %s. Headroom of %i process(es) %s.\n",bankerIsSafe(state) ? "safe" : "not safe",headroomRows,(proc < 0) ? "from one closure sweep per resource" : "from guided re-checks along the safe sequence");
+
+    //// One row of maximum safe grants per process (0 everywhere if the state is unsafe)
+    if (outputMode == OUTPUT_JSON) {
+        writerPutText(&OUTPUT_WRITER,bankerIsSafe(state) ? "{\"safe\":true,\"first\":" : "{\"safe\":false,\"first\":");
+        writerPutInt(&OUTPUT_WRITER,firstProc);
+        writerPutText(&OUTPUT_WRITER,",\"headroom\":[");
+    } else if (outputMode == OUTPUT_CSV) {
+        writerPutText(&OUTPUT_WRITER,"process");
+        for (int j = 0; j < colCount; ++j) {
+            writerPutText(&OUTPUT_WRITER,",R");
+            writerPutInt(&OUTPUT_WRITER,j);
+        }
+        writerPutText(&OUTPUT_WRITER,"\n");
+    } else if (outputMode == OUTPUT_FULL || outputMode == OUTPUT_DIFF) {
+        writerPutText(&OUTPUT_WRITER,"OUTPUT : Maximum safe grant per resource (each on its own):\n");
     }
-
-    resources[posInResArr] = new1dArray; // Already correct ptr type for array, no need for type conversion
-    return posInResArr;
+    for (int i = 0; i < headroomRows; ++i) {
+        const int *row = headroom + (size_t)i*colCount;
+        if (outputMode == OUTPUT_JSON) {
+            writerPutText(&OUTPUT_WRITER,(i > 0) ? ",[" : "[");
+            for (int j = 0; j < colCount; ++j) {
+                if (j > 0) { writerPutText(&OUTPUT_WRITER,","); }
+                writerPutInt(&OUTPUT_WRITER,row[j]);
+            }
+            writerPutText(&OUTPUT_WRITER,"]");
+            continue;
+        }
+        if (outputMode == OUTPUT_CSV) {
+            writerPutInt(&OUTPUT_WRITER,firstProc+i);
+            for (int j = 0; j < colCount; ++j) {
+                writerPutText(&OUTPUT_WRITER,",");
+                writerPutInt(&OUTPUT_WRITER,row[j]);
+            }
+            writerPutText(&OUTPUT_WRITER,"\n");
+            continue;
+        }
+        if (outputMode == OUTPUT_FULL || outputMode == OUTPUT_DIFF) {
+            writerPutText(&OUTPUT_WRITER,"OUTPUT : P");
+            writerPutInt(&OUTPUT_WRITER,firstProc+i);
+            writerPutText(&OUTPUT_WRITER," : ");
+        }
+        writerPutRow(&OUTPUT_WRITER,row,colCount); // Sequence/verdict: bare matrix rows, same layout as input arrays
+        writerPutText(&OUTPUT_WRITER,"\n");
+    }
+    if (outputMode == OUTPUT_JSON) { writerPutText(&OUTPUT_WRITER,"]}\n"); }
+    writerFlush(&OUTPUT_WRITER);
+    free(headroom);
+    return 0;
 }
-void skipReadLine(FILE* file) { // Skips a line (ending with \n)
-    char c = ' '; // Discardable char
-    do { // Gets next char -> checks if its a newline
-        c = fgetc(file); 
-    } while (c != '\n'); // Once newline, exits. Next read is past newline
+int setSchedule(bankerState *state, inputReader *reader, const char *orderName, int rowCount) { // Without a section every priority is 0 and every weight 1 (so cost counts positions)
+    SCHEDULE_VALUES = (int*)malloc(sizeof(int)*3*(size_t)rowCount);
+    if (SCHEDULE_VALUES == NULL) { return 1; }
+    int *priority = SCHEDULE_VALUES;
+    int *weight = SCHEDULE_VALUES + rowCount;
+    int *keys = SCHEDULE_VALUES + 2*(size_t)rowCount;
+    int sectionRead = (reader == NULL) ? -1 : readPrioritySection(reader,priority,weight,rowCount);
+    if (sectionRead == 1) { return 1; }
+    if (sectionRead == -1) {
+        for (int i = 0; i < rowCount; ++i) { priority[i] = 0; weight[i] = 1; }
+    }
+    for (int i = 0; i < rowCount; ++i) { keys[i] = (strcmp(orderName,"weight") == 0) ? ~weight[i] : priority[i]; } // Heaviest first: ~w = -w-1 falls as w grows and never overflows (-w would for INT_MIN)
+    bankerSetPriorities(state,(strcmp(orderName,"shortest") == 0) ? NULL : keys); // NULL keys are total remaining need
+    printInfo("INFO : Ready processes picked by %s%s.\n",orderName,(sectionRead == 0) ? "" : " (no priority section, priorities 0 and weights 1)");
+    return 0;
 }
-int readTabSep2dArray(FILE* file, int ** dataArray, int rowCount, int colCount) { // Read tab separated array into 2d array of known size
-    int invalidReadFlag = 0; // Set to 1 if invalid read
-    int val = -1; // Value should only need to be 'created' once
-    for (int i = 0; i < (rowCount*colCount); ++i) { // Read rows*cols values from file, fscanf handles newlines and tabs automatically
-        val = -1; // Invalid reads will show up CLEARLY as -1
-        
-        fscanf(file," %d",&val); // Read any whitespace and then integer (%d used to ensure base 10)
-        if (val < 0) { // Invalid read detected, will not continue reading and will return. (Should be no un-set values in array, thus partitial read ok)
-            invalidReadFlag = 1; 
-            return invalidReadFlag; // Used for readability, could return const int
-        } 
-        dataArray[(int)(i/colCount)][i%colCount] = val; // Sets value into array
-    }
-    char c = fgetc(file); // Skips char after table fully read (consumes newline after final value)
-    
-    return invalidReadFlag; // Values stored in array already, flag used for checking read success/fail
+void writeScheduleCost(int outputMode, const int *order, int queued, int rowCount) { // Each process runs for one time unit in sequence order, so completion time is its position
+    if (queued != rowCount) { // Unsafe, no completion for the rest
+        printInfo("INFO : No weighted completion cost, state is unsafe.\n");
+        return;
+    }
+    const int *weight = SCHEDULE_VALUES + rowCount;
+    long long cost = 0;
+    for (int k = 0; k < queued; ++k) { cost += (long long)weight[order[k]]*(k+1); }
+    char line[96];
+    if (outputMode == OUTPUT_FULL || outputMode == OUTPUT_DIFF) { snprintf(line,sizeof(line),"OUTPUT : Weighted completion cost (sum of weight x position): %lli\n",cost); }
+    else if (outputMode == OUTPUT_JSON) { snprintf(line,sizeof(line),"{\"weightedCost\":%lli}\n",cost); }
+    else if (outputMode == OUTPUT_CSV) { snprintf(line,sizeof(line),"weightedCost,%lli\n",cost); }
+    else { snprintf(line,sizeof(line),"%lli\n",cost); }
+    writerPutText(&OUTPUT_WRITER,line);
 }
-int readTabSep1dArray(FILE* file, int * dataArray, int valCount) { // Read tab separated array into 1d array of known size
-    int invalidReadFlag = 0; // Set to 1 if invalid read
-    int val = -1; // Value should only need to be 'created' once
-    for (int i = 0; i < valCount; ++i) {
-        val = -1; // Invalid reads will show up CLEARLY as -1
-        fscanf(file, " %d", &val); // Read any whitespace and then integer (%d used to ensure base 10)
-        if (val < 0) { // Invalid read detected, will not continue reading and will return. (Should be no un-set values in array, thus partitial read ok)
-            invalidReadFlag = 1; 
-            return invalidReadFlag;
-        } 
-        dataArray[i] = val; // Sets value into array
-    }
-    char c = fgetc(file); // Skips char after table fully read (consumes newline after final value)
-    
-    return invalidReadFlag; // Values stored in array already, flag used for checking read success/fail
+void printStats(bankerState *state, int statsMode, int outputMode, long long bytesParsed) { // Counters come from the checked state, times from marks in main and the readers
+#if BANKER_STATS
+    writerFlush(&OUTPUT_WRITER); // Results first (stdout flushed too, stats may go to stderr)
+    fflush(stdout);
+    FILE *target = (outputMode == OUTPUT_FULL || outputMode == OUTPUT_DIFF) ? stdout : stderr;
+    bankerCounters counters;
+    bankerGetCounters(state,&counters);
+    struct rusage usage;
+    long peakKb = (getrusage(RUSAGE_SELF,&usage) == 0) ? usage.ru_maxrss : -1; // Linux reports kilobytes
+    double total = 0;
+    for (int p = 0; p < STATS_PHASES; ++p) { total += RUN_STATS.phaseSeconds[p]; }
+    if (statsMode == 2) { // One line, no tag
+        fprintf(target,"{\"stats\":{\"seconds\":{");
+        for (int p = 0; p < STATS_PHASES; ++p) { fprintf(target,"\"%s\":%.6f,",STATS_PHASE_NAMES[p],RUN_STATS.phaseSeconds[p]); }
+        fprintf(target,"\"total\":%.6f},\"checks\":%lli,\"rowCompares\":%lli,\"earlyExits\":%lli,\"needWakes\":%lli,",total,counters.checks,counters.rowCompares,counters.earlyExits,counters.needWakes);
+        fprintf(target,"\"bytesParsed\":%lli,\"bytesWritten\":%lli,\"peakMemoryKb\":%li}}\n",bytesParsed,OUTPUT_WRITER.written,peakKb);
+    } else {
+        for (int p = 0; p < STATS_PHASES; ++p) { fprintf(target,"STATS : %-7s %10.6f s\n",STATS_PHASE_NAMES[p],RUN_STATS.phaseSeconds[p]); }
+        fprintf(target,"STATS : %-7s %10.6f s\n","total",total);
+        fprintf(target,"STATS : Checks %lli, row compares %lli, early exits %lli, need wakes %lli\n",counters.checks,counters.rowCompares,counters.earlyExits,counters.needWakes);
+        fprintf(target,"STATS : Bytes parsed %lli, bytes written %lli, peak memory %li KB\n",bytesParsed,OUTPUT_WRITER.written,peakKb);
+    }
+    fflush(target);
+#else
+    (void)state; (void)statsMode; (void)outputMode; (void)bytesParsed;
+#endif
 }
-int subtract2dArrays(int ** result, int ** firstArr, int ** secondArr, int rowCount, int colCount) { // Subtracts second Array from first Array and stores it in result (known,same size). Returns 1 if any negative value exists
-    int resultValNegative = 0; // Flag for any negative values (convinence for this program, not needed otherwise)
-    for (int i = 0; i < rowCount; ++i) {
-        for (int j = 0; j < colCount; ++j) {
-            result[i][j] = firstArr[i][j] - secondArr[i][j]; // Component-wise subtraction
-            if (result[i][j] < 0) { resultValNegative = 1; } // Checks if any negative values were stored
-        }
+int parseCommandVector(char *text, int *vector, int colCount, int *proc) { // Parses 'Pi v1 .. vcols' (non-negative values), nothing else allowed on line
+    char *endPtr = NULL;
+    while (isspace((unsigned char)*text)) { ++text; }
+    if (*text != 'P' && *text != 'p') { return 1; } // Process must be given as P#
+    ++text;
+    if (!isdigit((unsigned char)*text)) { return 1; }
+    long val = strtol(text,&endPtr,10);
+    if (val > 0x7FFFFFFF) { return 1; }
+    *proc = (int)val;
+    text = endPtr;
+    for (int j = 0; j < colCount; ++j) {
+        while (isspace((unsigned char)*text)) { ++text; }
+        if (!isdigit((unsigned char)*text)) { return 1; } // Missing or negative value
+        val = strtol(text,&endPtr,10);
+        if (val > 0x7FFFFFFF) { return 1; }
+        vector[j] = (int)val;
+        text = endPtr;
     }
-    return resultValNegative;
+    while (isspace((unsigned char)*text)) { ++text; }
+    return (*text != '\0'); // Extra values are malformed
 }
-void cleanupAllocs(int **resources, int resourceCount, int filesUsed, int toDealloc) { // General function to cleanup CURRENTLY allocated resources
-    if (toDealloc == -1) { // Deallocate ALL currently available resources
-        for (int i = 0; i < resourceCount; ++i) { // Loops through all ptrs
-            if (i < filesUsed) { // Ptrs from fopen()
-                if (resources[i] != NULL) { // Ensures resource is allocated
-                    fclose((FILE*)resources[i]);
-                    resources[i] = NULL;
+int runBatch(char **inputPaths, int inputCount, int outputMode) { // Verdict per snapshot, state only recreated when a snapshot is larger than any before it
+    bankerState *states[2] = {NULL,NULL}; // Shared by every snapshot: text snapshots are loaded into [0], binary ones only borrow scratch of [1] (BANKER_VIEW_ONLY, no matrices)
+    int safeCount = 0;
+    int unsafeCount = 0;
+    int errorCount = 0;
+    char errorText[128]; // 'ERROR reason' verdict for writeBatchRecord
+    if (outputMode == OUTPUT_CSV) { writerPutText(&OUTPUT_WRITER,"input,snapshot,processes,resources,verdict\n"); }
+
+    for (int f = 0; f < inputCount; ++f) {
+        inputReader inputFile; // Mapped (or block-read) input, closed after its last snapshot
+        if (openInputReader(&inputFile,inputPaths[f])) {
+            writeBatchRecord(&OUTPUT_WRITER,outputMode,inputPaths[f],0,-1,0,"ERROR cannot open",NULL,0);
+            ++errorCount;
+            continue;
+        }
+
+        for (int snapshot = 1; ; ++snapshot) { // Back-to-back snapshots until end of file
+            int procCount = 0;
+            int resCount = 0;
+            binaryView view;
+            int isBinary = readerIsBinary(&inputFile);
+            if (isBinary) { // Binary record checked in place, need block precomputed
+                if (mapBinarySnapshot(&inputFile,&view)) { // Record size unknown, skip rest of input
+                    writeBatchRecord(&OUTPUT_WRITER,outputMode,inputPaths[f],snapshot,-1,0,"ERROR invalid binary snapshot",NULL,0);
+                    ++errorCount;
+                    break;
+                }
+                procCount = view.rowCount;
+                resCount = view.colCount;
+                int badRow = 0;
+                int needResult = checkBinaryNeed(&view,&badRow); // Need block is used in place, so it must be max - alloc
+                if (needResult != BINARY_NEED_OK) { // Record size known, next one can still be evaluated
+                    if (needResult == BINARY_NEED_NEGATIVE) { snprintf(errorText,sizeof(errorText),"ERROR allocated exceeds maximum"); }
+                    else { snprintf(errorText,sizeof(errorText),"ERROR need of P%i is not maximum - allocated",badRow); }
+                    writeBatchRecord(&OUTPUT_WRITER,outputMode,inputPaths[f],snapshot,procCount,resCount,errorText,NULL,0);
+                    ++errorCount;
+                    continue;
+                }
+            } else {
+                int headerRead = readTextHeader(&inputFile,&procCount,&resCount);
+                if (headerRead == READ_END) { break; } // No more snapshots
+                if (headerRead != READ_OK) { // Stream position unknown after bad header, skip rest of input
+                    snprintf(errorText,sizeof(errorText),"ERROR invalid header at line %li",inputFile.line);
+                    writeBatchRecord(&OUTPUT_WRITER,outputMode,inputPaths[f],snapshot,-1,0,errorText,NULL,0);
+                    ++errorCount;
+                    break;
                 }
-            } else { // Ptrs from malloc()
-                free(resources[i]); // Dealloc. free(NULL) does nothing, no need for check - C99_7.20.3.2
-                resources[i] = NULL; // Mark as deallocated
             }
+
+            bankerState *state = states[isBinary];
+            if (state == NULL || procCount > bankerRowCapacity(state) || resCount > bankerColCapacity(state)) { // Grow to fit (values not kept)
+                int rowCapacity = (state != NULL && bankerRowCapacity(state) > procCount) ? bankerRowCapacity(state) : procCount;
+                int colCapacity = (state != NULL && bankerColCapacity(state) > resCount) ? bankerColCapacity(state) : resCount;
+                bankerDestroy(state);
+                state = createCliState(rowCapacity,colCapacity,isBinary ? BANKER_VIEW_ONLY : 0);
+                states[isBinary] = state;
+                if (state == NULL) {
+                    bankerDestroy(states[!isBinary]);
+                    writerFlush(&OUTPUT_WRITER);
+                    printf("ERROR : Could not allocate %i x %i state for batch input (%s).\n",procCount,resCount,inputPaths[f]);
+                    closeInputReader(&inputFile);
+                    return 1;
+                }
+            }
+
+            int queuedCount = 0;
+            if (isBinary) { queuedCount = bankerCheckView(state,procCount,resCount,view.alloc,view.need,view.avail,view.rowStride); }
+            else {
+                bankerBeginLoad(state,procCount,resCount);
+                if (readSnapshotBody(&inputFile,bankerAllocRows(state),bankerMaxRows(state),bankerAvailable(state),procCount,resCount)) { // Stream position unknown after bad value, skip rest of input
+                    snprintf(errorText,sizeof(errorText),"ERROR invalid value at line %li column %li (%s)",inputFile.errorLine,inputFile.errorColumn,readerErrorText(inputFile.errorKind));
+                    writeBatchRecord(&OUTPUT_WRITER,outputMode,inputPaths[f],snapshot,-1,0,errorText,NULL,0);
+                    ++errorCount;
+                    break;
+                }
+                if (bankerEndLoad(state) != BANKER_OK) { // Snapshot fully read, next one can still be evaluated
+                    writeBatchRecord(&OUTPUT_WRITER,outputMode,inputPaths[f],snapshot,procCount,resCount,"ERROR allocated exceeds maximum",NULL,0);
+                    ++errorCount;
+                    continue;
+                }
+                queuedCount = bankerCheck(state);
+            }
+            if (queuedCount == procCount) { ++safeCount; } 
+            else { ++unsafeCount; }
+            writeBatchRecord(&OUTPUT_WRITER,outputMode,inputPaths[f],snapshot,procCount,resCount,(queuedCount == procCount) ? "SAFE" : "UNSAFE",bankerOrder(state),queuedCount);
         }
-        return; // Returns immediately
-    }
-    
-    // Deallocating SPECIFIC FILE resource
-    if (toDealloc < filesUsed) { // If ptr to dealloc is a file (opened with fopen())
-        if (resources[toDealloc] == NULL) { return; } // Already deallocated 
-        
-        fclose((FILE*)resources[toDealloc]); // Deallocates target file
-        resources[toDealloc] = NULL; // Marks position as deallocated
-        return; // Returns, resource deallocated
+        closeInputReader(&inputFile);
     }
 
-    // Deallocating SPECIFIC MALLOC resource
-    free(resources[toDealloc]); // Free memory at ptr. free(NULL) does nothing - C99_7.20.3.2
-    resources[toDealloc] = NULL; // Mark as deallocated
-    return;
+    writerFlush(&OUTPUT_WRITER);
+    printInfo("INFO : Batch evaluated %i snapshots: %i safe, %i unsafe, %i errors.\n",safeCount+unsafeCount+errorCount,safeCount,unsafeCount,errorCount);
+    bankerDestroy(states[0]);
+    bankerDestroy(states[1]);
+    return (errorCount > 0);
 }
-void copy1dArray(int *targetArray, int *sourceArray, int size) { // Copy contents of 1d array to another (of known size)
-    for (int i = 0; i < size; ++i) { // Copy all elements of 1d array
-        targetArray[i] = sourceArray[i]; 
+int runConvert(char *inputPath, char *outputPath) { // Text snapshots -> binary records, or binary records -> text snapshots (direction from input magic)
+    inputReader inputFile; // Mapped (or block-read) input
+    if (openInputReader(&inputFile,inputPath)) {
+        printf("ERROR : File (%s) does not exist or cannot be opened.\n",inputPath);
+        return 1;
     }
-}
-void printCurrentState(int **maximumAllocatable,int **currentlyAllocated,int **neededAllocation,int *availableResources, int rowCount, int colCount, int selProccess) { // Uses printf to output current system state (defined by passed arrays) If selected proccess = -1, none highlighted
-    // Arbitrary printf output of current system state, as stored in passed array ptrs
-    printf("OUTPUT : P# |  Max  | Alloc | Needs | Avail\n");
-    for (int i = 0; i < rowCount; ++i) { // Loop through all rows of arrays
-        // Highlighted proccess check (adds emphasis on proccess to-be-executed)
-        if (i == selProccess) { // Outputs start of each line as needed, with printf 'tag' 
-            printf("OUTPUT : >> P%i | ",i); // If proccess selected, will be slightly offset from other proccesses in state snapshots
-        } else {
-            printf("OUTPUT : P%i | ",i); 
-        }
-        
-        // Output primary arrays for every line
-        for (int j = 0; j < colCount; ++j) { // Print all columns for max...
-            printf("%i ",maximumAllocatable[i][j]);
-        }
-        printf("| ");
-        for (int j = 0; j < colCount; ++j) { // Print all columns for current...
-            printf("%i ",currentlyAllocated[i][j]);
+    FILE *outputFile = fopen(outputPath,"wb");
+    if (outputFile == NULL) {
+        printf("ERROR : File (%s) cannot be opened for writing.\n",outputPath);
+        closeInputReader(&inputFile);
+        return 1;
+    }
+    int toText = readerIsBinary(&inputFile); // Direction decided by first snapshot
+    bankerState *state = NULL; // Every snapshot is loaded into state (recreated only when a larger one arrives), need computed by bankerEndLoad
+    int converted = 0;
+    int failed = 0;
+
+    while (!failed) {
+        int procCount = 0;
+        int resCount = 0;
+        binaryView view;
+        if (toText) { // Binary record -> text snapshot
+            if (inputFile.pos == inputFile.len) { break; } // All records converted
+            if (mapBinarySnapshot(&inputFile,&view)) {
+                printf("ERROR : Invalid binary snapshot #%i in (%s).\n",converted+1,inputPath);
+                failed = 1;
+                break;
+            }
+            procCount = view.rowCount;
+            resCount = view.colCount;
+        } else { // Text snapshot -> binary record (need computed once here, not at every load)
+            int headerRead = readTextHeader(&inputFile,&procCount,&resCount);
+            if (headerRead == READ_END) { break; } // All snapshots converted
+            if (headerRead != READ_OK) {
+                printf("ERROR : Invalid header of snapshot #%i in (%s) at line %li.\n",converted+1,inputPath,inputFile.line);
+                failed = 1;
+                break;
+            }
         }
-        printf("| ");
-        for (int j = 0; j < colCount; ++j) { // Print all columns for needed...
-            printf("%i ",neededAllocation[i][j]);
+        if (state == NULL || procCount > bankerRowCapacity(state) || resCount > bankerColCapacity(state)) {
+            int rowCapacity = (state != NULL && bankerRowCapacity(state) > procCount) ? bankerRowCapacity(state) : procCount;
+            int colCapacity = (state != NULL && bankerColCapacity(state) > resCount) ? bankerColCapacity(state) : resCount;
+            bankerDestroy(state);
+            state = bankerCreate(rowCapacity,colCapacity,0);
+            if (state == NULL) {
+                printf("ERROR : Could not allocate %i x %i arrays for conversion.\n",procCount,resCount);
+                failed = 1;
+                break;
+            }
         }
-        printf("| "); // Spacer for values
-
-        // For first line of data, also output 'available' resources
-        if (i == 0) {
-            for (int j = 0; j < colCount; ++j) {
-                printf("%i ",availableResources[j]); // Output Avail resources
+        if (toText) {
+            if (bankerLoad(state,procCount,resCount,view.alloc,view.max,view.avail,view.rowStride) != BANKER_OK) {
+                printf("ERROR : Invalid binary snapshot #%i in (%s).\n",converted+1,inputPath);
+                failed = 1;
+                break;
+            }
+            failed = writeTextSnapshot(outputFile,bankerAllocRows(state),bankerMaxRows(state),bankerAvailable(state),procCount,resCount);
+        } else {
+            bankerBeginLoad(state,procCount,resCount);
+            if (readSnapshotBody(&inputFile,bankerAllocRows(state),bankerMaxRows(state),bankerAvailable(state),procCount,resCount)) {
+                printf("ERROR : Invalid value in snapshot #%i of (%s) (line %li, column %li: %s).\n",converted+1,inputPath,inputFile.errorLine,inputFile.errorColumn,readerErrorText(inputFile.errorKind));
+                failed = 1;
+                break;
             }
+            if (bankerEndLoad(state) != BANKER_OK) {
+                printf("ERROR : Snapshot #%i of (%s) allocates more than its maximum.\n",converted+1,inputPath);
+                failed = 1;
+                break;
+            }
+            failed = writeBinarySnapshot(outputFile,bankerAllocRows(state),bankerMaxRows(state),bankerNeedRows(state),bankerAvailable(state),procCount,resCount);
         }
-        printf("\n"); // Terminate line 
+        if (failed) { printf("ERROR : Write to (%s) failed.\n",outputPath); }
+        else { ++converted; }
     }
-}
\ No newline at end of file
+    if (fclose(outputFile) != 0 && !failed) { printf("ERROR : Write to (%s) failed.\n",outputPath); failed = 1; }
+    if (!failed) { printInfo("INFO : Converted %i snapshots from (%s) to %s (%s).\n",converted,inputPath,toText ? "text" : "binary",outputPath); }
+    closeInputReader(&inputFile);
+    bankerDestroy(state);
+    return failed;
+}
+int exitCleanup(inputReader *reader, bankerState *state, int exitCode) { // Single cleanup path for main (reader may already be closed, state may be NULL)
+    closeInputReader(reader);
+    bankerDestroy(state);
+    free(SCHEDULE_VALUES);
+    SCHEDULE_VALUES = NULL;
+    return exitCode;
+}
+bankerState *createCliState(int rowCount, int colCount, int extraFlags) { // Flags and threads follow command line (-p, -j, -s, -n)
+    bankerState *state = bankerCreate(rowCount,colCount,STATE_FLAGS | extraFlags);
+    if (state != NULL) { bankerSetThreads(state,SAFETY_THREADS); }
+    return state;
+}
@@ -0,0 +1,346 @@
+///// Alex Tregub
+///// CS33211-001
+///// Banker's Algorithm workload generator + benchmark harness
+///// ===========
+///// v1.19.0
+///// Generates synthetic system states (safe, unsafe or barely-safe) in the
+/////     text snapshot format, and times the parse, safety check and output
+/////     phases separately over a sweep of process/resource counts. Results
+/////     are written as CSV so builds can be compared against each other.
+///// - Compile via > ./buildBenchScript.sh
+///// - Run via > ./bankersBench [options] [RESULTS.csv] (CSV to stdout, without INFO lines, if no file given)
+/////     - Option -g OUT : only generate one workload (first -n/-m value) into OUT ('-' is stdout), no timing
+/////     - Option -n LIST / -m LIST : process / resource counts of sweep (comma separated, eg. -n 100,1000 -m 1,8,64)
+/////     - Option -t LIST : workload kinds (safe, unsafe, barely), default safe
+/////     - Option -v MAX : allocated/available values drawn from 0..MAX (default 9). Option -d PERCENT : non-zero alloc/need entries (default 100)
+/////     - Option -u PERCENT : processes that can never finish in unsafe workloads (default 10, at least 1)
+/////     - Option -s SEED : random seed (default 1). Option -r N : repeats per size, fastest kept (default 3)
+/////     - Option -l VALUES : skip sizes with more than VALUES (n*m) values (default 4194304)
+/////     - Option -o MODE : output mode timed in output phase (default diff, output goes to /dev/null)
+/////     - Option -k KERNELS / -j N / -p : row kernels, check threads and lowest index first order, as in bankersAlgo
+/////     - Option -G : generic row loops only, without the kernels generated for 1..16 resources (baseline for width kernel speedups)
+/////     - Option -z STORAGE : auto (default), dense or sparse state storage, as in bankersAlgo (full/diff output always dense)
+/////     - Option -L LABEL : build label stored in every CSV row (default local). Option -w DIR : directory for generated inputs (default /tmp)
+///// ===========
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "bankersLib.h"
+#include "bankersIO.h"
+
+#define WORKLOAD_SAFE 0 // Workload kinds (-t): random needs along a hidden safe sequence
+#define WORKLOAD_UNSAFE 1 // Safe prefix, then a blocked suffix that can never finish
+#define WORKLOAD_BARELY 2 // Every need equals available at its turn in the hidden sequence (no slack anywhere)
+#define BENCH_MAX_LIST 32 // Max entries in -n/-m/-t lists
+#define BENCH_DEFAULT_LIMIT (1<<22) // Default max n*m values per generated input
+
+typedef struct workloadSpec { // Everything a generated state depends on (same spec + seed gives same file)
+    int rowCount;
+    int colCount;
+    int kind; // WORKLOAD_*
+    int maxValue; // Allocated/available values drawn from 0..maxValue
+    int density; // Percent of alloc/need entries that are non-zero
+    int blockedPercent; // Unsafe only: percent of processes in blocked suffix
+    uint64_t seed;
+} workloadSpec;
+
+outputWriter BENCH_WRITER; // Writer for generated inputs and timed output phase
+int SHOW_INFO = 1; // 0 if CSV goes to stdout (INFO lines would mix with it)
+
+uint64_t nextRandom(uint64_t*); // splitmix64 step. Takes: rngState (updated). Returns 64 random bits
+int randomUpTo(uint64_t*,int); // Params: rngState,bound. Returns uniform value in 0..bound
+int generateWorkload(FILE*,const workloadSpec*); // Writes one text snapshot for spec. Params: output file,spec. Returns 0 if success, 1 if alloc/write failed
+void writeTabRow(outputWriter*,const int*,int); // Writes tab separated row + newline. Params: writer,row,cols
+int parseIntList(const char*,int*,int); // Parses comma separated positive ints. Params: text,outputList,maxCount. Returns count (0 if malformed)
+int parseWorkloadKind(const char*,int); // Params: name,nameLength. Returns WORKLOAD_* value, -1 if unknown
+const char *workloadKindName(int); // Takes: WORKLOAD_* value
+double nowSeconds(void); // Monotonic clock in seconds
+
+
+
+int main(int argc, char *argv[]) {
+    //// Parse options, results file is the last non-option argument
+    workloadSpec spec = {0,0,WORKLOAD_SAFE,9,100,10,1};
+    int rowList[BENCH_MAX_LIST] = {100,1000,10000,100000,1000000};
+    int colList[BENCH_MAX_LIST] = {1,8,12,13,14,15,64,512}; // 12..15: AVX2 kernels hand 4-7 col tails to SSE2
+    int kindList[BENCH_MAX_LIST] = {WORKLOAD_SAFE};
+    int rowListCount = 5;
+    int colListCount = 8;
+    int kindListCount = 1;
+    char *generatePath = NULL; // -g, generate only
+    char *resultsPath = NULL; // CSV file, stdout if NULL
+    char *kernelName = "auto";
+    char *outputName = "diff";
+    char *storageName = "auto";
+    char *label = "local";
+    char *workDir = "/tmp";
+    int repeats = 3;
+    long long valueLimit = BENCH_DEFAULT_LIMIT;
+    int threads = 1;
+    int stateFlags = 0;
+    for (int i = 1; i < argc; ++i) {
+        int hasValue = (i+1 < argc);
+        if (strcmp(argv[i],"-g") == 0 && hasValue) { generatePath = argv[++i]; }
+        else if (strcmp(argv[i],"-n") == 0 && hasValue) { rowListCount = parseIntList(argv[++i],rowList,BENCH_MAX_LIST); }
+        else if (strcmp(argv[i],"-m") == 0 && hasValue) { colListCount = parseIntList(argv[++i],colList,BENCH_MAX_LIST); }
+        else if (strcmp(argv[i],"-t") == 0 && hasValue) { // Kind list, eg. safe,unsafe
+            char *names = argv[++i];
+            kindListCount = 0;
+            while (kindListCount >= 0 && *names != '\0' && kindListCount < BENCH_MAX_LIST) {
+                int length = (int)strcspn(names,",");
+                int kind = parseWorkloadKind(names,length);
+                if (kind == -1) { kindListCount = -1; break; }
+                kindList[kindListCount++] = kind;
+                names += length + (names[length] == ',');
+            }
+            if (kindListCount <= 0) { printf("ERROR : Workload kinds (%s) unknown (safe, unsafe, barely).\n",argv[i]); return 1; }
+        }
+        else if (strcmp(argv[i],"-v") == 0 && hasValue) { spec.maxValue = atoi(argv[++i]); }
+        else if (strcmp(argv[i],"-d") == 0 && hasValue) { spec.density = atoi(argv[++i]); }
+        else if (strcmp(argv[i],"-u") == 0 && hasValue) { spec.blockedPercent = atoi(argv[++i]); }
+        else if (strcmp(argv[i],"-s") == 0 && hasValue) { spec.seed = strtoull(argv[++i],NULL,10); }
+        else if (strcmp(argv[i],"-r") == 0 && hasValue) { repeats = atoi(argv[++i]); }
+        else if (strcmp(argv[i],"-l") == 0 && hasValue) { valueLimit = atoll(argv[++i]); }
+        else if (strcmp(argv[i],"-o") == 0 && hasValue) { outputName = argv[++i]; }
+        else if (strcmp(argv[i],"-k") == 0 && hasValue) { kernelName = argv[++i]; }
+        else if (strcmp(argv[i],"-z") == 0 && hasValue) { storageName = argv[++i]; }
+        else if (strcmp(argv[i],"-j") == 0 && hasValue) { threads = atoi(argv[++i]); stateFlags |= BANKER_ROUNDS; }
+        else if (strcmp(argv[i],"-p") == 0) { stateFlags |= BANKER_LOWEST_FIRST; }
+        else if (strcmp(argv[i],"-G") == 0) { stateFlags |= BANKER_GENERIC_WIDTH; }
+        else if (strcmp(argv[i],"-L") == 0 && hasValue) { label = argv[++i]; }
+        else if (strcmp(argv[i],"-w") == 0 && hasValue) { workDir = argv[++i]; }
+        else if (argv[i][0] == '-') { printf("ERROR : Unknown option (%s).\n",argv[i]); return 1; }
+        else { resultsPath = argv[i]; }
+    }
+    int outputMode = parseOutputMode(outputName);
+    int storageMode = parseStorageMode(storageName);
+    if (rowListCount == 0 || colListCount == 0) { printf("ERROR : Size lists must be comma separated positive ints.\n"); return 1; }
+    if (spec.maxValue < 1 || spec.density < 1 || spec.density > 100 || spec.blockedPercent < 0 || spec.blockedPercent > 100 || repeats < 1) {
+        printf("ERROR : Values need -v >= 1, -d 1..100, -u 0..100, -r >= 1.\n");
+        return 1;
+    }
+    if (outputMode == -1) { printf("ERROR : Output mode (%s) unknown (full, diff, sequence, verdict, json, csv).\n",outputName); return 1; }
+    if (storageMode == -1) { printf("ERROR : Storage (%s) unknown (auto, dense, sparse).\n",storageName); return 1; }
+    if (outputMode == OUTPUT_FULL || outputMode == OUTPUT_DIFF) { storageMode = STORAGE_DENSE; } // Tables need row ptrs
+    if (bankerSelectKernels(kernelName)) { printf("ERROR : Row kernels (%s) unknown or not supported by this cpu (auto, scalar, sse2, avx2).\n",kernelName); return 1; }
+    if (threads < 1 || threads > BANKER_MAX_THREADS) { printf("ERROR : Thread count must be 1 to %d.\n",BANKER_MAX_THREADS); return 1; }
+
+    //// Generate only
+    if (generatePath != NULL) {
+        spec.rowCount = rowList[0];
+        spec.colCount = colList[0];
+        spec.kind = kindList[0];
+        FILE *output = (strcmp(generatePath,"-") == 0) ? stdout : fopen(generatePath,"wb");
+        if (output == NULL) { printf("ERROR : File (%s) cannot be opened for writing.\n",generatePath); return 1; }
+        int failed = generateWorkload(output,&spec);
+        if (output != stdout && fclose(output) != 0) { failed = 1; }
+        if (failed) { printf("ERROR : Could not generate %i x %i workload into (%s).\n",spec.rowCount,spec.colCount,generatePath); }
+        return failed;
+    }
+
+    //// Sweep: generate each size once, then parse -> check -> output 'repeats' times (fastest of each phase kept)
+    FILE *results = (resultsPath == NULL) ? stdout : fopen(resultsPath,"w");
+    if (results == NULL) { printf("ERROR : File (%s) cannot be opened for writing.\n",resultsPath); return 1; }
+    SHOW_INFO = (resultsPath != NULL);
+    FILE *discard = fopen("/dev/null","w"); // Output phase target, formatting + write calls are timed without disk cost
+    if (discard == NULL) { printf("ERROR : Cannot open /dev/null for output phase.\n"); return 1; }
+    char inputPath[4096];
+    snprintf(inputPath,sizeof(inputPath),"%s/bankersBench_%li.txt",workDir,(long)getpid());
+    fprintf(results,"label,kind,processes,resources,density,max_value,seed,input_bytes,repeats,parse_s,check_s,output_s,total_s,verdict,kernels,threads,output_mode,storage,width_kernels\n");
+    fflush(results);
+
+    int failed = 0;
+    for (int k = 0; k < kindListCount && !failed; ++k) {
+        for (int r = 0; r < rowListCount && !failed; ++r) {
+            for (int c = 0; c < colListCount && !failed; ++c) {
+                spec.kind = kindList[k];
+                spec.rowCount = rowList[r];
+                spec.colCount = colList[c];
+                if ((long long)spec.rowCount*spec.colCount > valueLimit) {
+                    if (SHOW_INFO) { printf("INFO : Skipping %i x %i (over -l %lli values).\n",spec.rowCount,spec.colCount,valueLimit); }
+                    continue;
+                }
+                FILE *input = fopen(inputPath,"wb");
+                if (input == NULL || generateWorkload(input,&spec) || fclose(input) != 0) {
+                    printf("ERROR : Could not generate %i x %i workload into (%s).\n",spec.rowCount,spec.colCount,inputPath);
+                    failed = 1;
+                    break;
+                }
+                struct stat inputInfo;
+                long long inputBytes = (stat(inputPath,&inputInfo) == 0) ? (long long)inputInfo.st_size : -1;
+
+                double bestParse = 1e30;
+                double bestCheck = 1e30;
+                double bestOutput = 1e30;
+                int queued = -1;
+                int sparse = 0;
+                for (int rep = 0; rep < repeats && !failed; ++rep) {
+                    // Parse phase: open + scan into a fresh state, need computed (same path as bankersAlgo single-file mode)
+                    double start = nowSeconds();
+                    inputReader reader;
+                    int procCount = 0;
+                    int resCount = 0;
+                    int readResult = 0;
+                    bankerState *state = NULL;
+                    if (openInputReader(&reader,inputPath) || readTextHeader(&reader,&procCount,&resCount) != READ_OK) { failed = 1; }
+                    if (!failed) { state = loadTextState(&reader,procCount,resCount,stateFlags,storageMode,&readResult); }
+                    if (state == NULL || readResult != 0 || bankerEndLoad(state) != BANKER_OK) { failed = 1; }
+                    else {
+                        bankerSetThreads(state,threads);
+                        sparse = bankerIsSparse(state);
+                    }
+                    closeInputReader(&reader);
+                    if (failed) {
+                        printf("ERROR : Could not load generated %i x %i workload (%s).\n",spec.rowCount,spec.colCount,inputPath);
+                        bankerDestroy(state);
+                        break;
+                    }
+                    double parsed = nowSeconds();
+
+                    // Check phase
+                    queued = bankerCheck(state);
+                    double checked = nowSeconds();
+
+                    // Output phase (writer reused, so only formatting + writes are timed)
+                    BENCH_WRITER.file = discard;
+                    BENCH_WRITER.used = 0;
+                    writeSnapshotResult(&BENCH_WRITER,outputMode,bankerMaxRows(state),bankerAllocRows(state),bankerNeedRows(state),bankerAvailable(state),bankerFinalAvailable(state),procCount,resCount,bankerOrder(state),queued);
+                    writerFlush(&BENCH_WRITER);
+                    double written = nowSeconds();
+                    bankerDestroy(state);
+
+                    if (parsed - start < bestParse) { bestParse = parsed - start; }
+                    if (checked - parsed < bestCheck) { bestCheck = checked - parsed; }
+                    if (written - checked < bestOutput) { bestOutput = written - checked; }
+                }
+                remove(inputPath);
+                if (failed) { break; }
+
+                fprintf(results,"%s,%s,%i,%i,%i,%i,%llu,%lli,%i,%.6f,%.6f,%.6f,%.6f,%s,%s,%i,%s,%s,%s\n",label,workloadKindName(spec.kind),spec.rowCount,spec.colCount,spec.density,spec.maxValue,(unsigned long long)spec.seed,inputBytes,repeats,
+                    bestParse,bestCheck,bestOutput,bestParse+bestCheck+bestOutput,(queued == spec.rowCount) ? "SAFE" : "UNSAFE",bankerKernelName(),threads,outputName,sparse ? "sparse" : "dense",(spec.colCount <= BANKER_WIDTH_KERNEL_MAX && !(stateFlags & BANKER_GENERIC_WIDTH)) ? "fixed" : "generic"); // Sparse states have no width kernels, storage column tells
+                fflush(results); // Rows of finished sizes kept if a later (larger) size is interrupted
+                if (SHOW_INFO) { printf("INFO : %s %i x %i: parse %.6fs, check %.6fs, output %.6fs.\n",workloadKindName(spec.kind),spec.rowCount,spec.colCount,bestParse,bestCheck,bestOutput); }
+            }
+        }
+    }
+    fclose(discard);
+    if (results != stdout && fclose(results) != 0) { printf("ERROR : Write to (%s) failed.\n",resultsPath); failed = 1; }
+    return failed;
+}
+
+
+
+//// Function definitions
+uint64_t nextRandom(uint64_t *rngState) { // splitmix64, fast and good enough for workloads (rand() is too short on some platforms)
+    uint64_t z = (*rngState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+int randomUpTo(uint64_t *rngState, int bound) { // Modulo bias negligible for bounds far below 2^64
+    return (int)(nextRandom(rngState) % ((uint64_t)bound + 1));
+}
+int generateWorkload(FILE *output, const workloadSpec *spec) { // Needs are drawn along a hidden random sequence, so safety is known by construction
+    // Values stay below 2^31: available + every allocated value bounds every need (n*maxValue), max = alloc + need
+    int rows = spec->rowCount;
+    int cols = spec->colCount;
+    if (rows <= 0 || cols <= 0 || (long long)rows*spec->maxValue*2 + spec->maxValue + 1 > 0x7FFFFFFF) { return 1; }
+    int *matrix = (int*)malloc(sizeof(int)*(size_t)rows*(size_t)cols); // Allocated rows, then overwritten with maximum rows (alloc + need)
+    int *work = (int*)malloc(sizeof(int)*(size_t)cols); // Available once every process before position k of hidden sequence finished
+    int *available = (int*)malloc(sizeof(int)*(size_t)cols);
+    int *sequence = (int*)malloc(sizeof(int)*(size_t)rows);
+    if (matrix == NULL || work == NULL || available == NULL || sequence == NULL) {
+        free(matrix);
+        free(work);
+        free(available);
+        free(sequence);
+        return 1;
+    }
+    uint64_t rng = spec->seed;
+    for (size_t i = 0; i < (size_t)rows*(size_t)cols; ++i) { matrix[i] = (randomUpTo(&rng,99) < spec->density) ? randomUpTo(&rng,spec->maxValue) : 0; }
+    for (int j = 0; j < cols; ++j) {
+        available[j] = randomUpTo(&rng,spec->maxValue);
+        work[j] = available[j];
+    }
+    for (int i = 0; i < rows; ++i) { sequence[i] = i; }
+    for (int i = rows-1; i > 0; --i) { // Fisher-Yates shuffle, hidden sequence is not index order
+        int swap = randomUpTo(&rng,i);
+        int temp = sequence[i];
+        sequence[i] = sequence[swap];
+        sequence[swap] = temp;
+    }
+
+    BENCH_WRITER.file = output;
+    BENCH_WRITER.used = 0;
+    BENCH_WRITER.failed = 0;
+    writerPutInt(&BENCH_WRITER,rows);
+    writerPutText(&BENCH_WRITER,"\t");
+    writerPutInt(&BENCH_WRITER,cols);
+    writerPutText(&BENCH_WRITER,"\nSystem's currently allocated resources (n*m)\n");
+    for (int i = 0; i < rows; ++i) { writeTabRow(&BENCH_WRITER,matrix + (size_t)i*cols,cols); }
+
+    // Unsafe: last blockedCount of hidden sequence each need one more unit of some resource than the finished prefix can ever free
+    int blockedCount = (spec->kind == WORKLOAD_UNSAFE) ? (int)((long long)rows*spec->blockedPercent/100) : 0;
+    if (spec->kind == WORKLOAD_UNSAFE && blockedCount < 1) { blockedCount = 1; }
+    for (int k = 0; k < rows; ++k) {
+        int *row = matrix + (size_t)sequence[k]*cols;
+        int blocked = (k >= rows - blockedCount);
+        for (int j = 0; j < cols; ++j) { // Need drawn against work before this process, alloc released after it
+            int need = 0;
+            if (randomUpTo(&rng,99) < spec->density) { need = (spec->kind == WORKLOAD_BARELY) ? work[j] : randomUpTo(&rng,work[j]); }
+            if (!blocked) { work[j] += row[j]; }
+            row[j] += need;
+        }
+        if (blocked) { // Work is frozen at prefix total, no blocked process can ever run
+            int j = randomUpTo(&rng,cols-1);
+            row[j] += work[j] + 1;
+        }
+    }
+    writerPutText(&BENCH_WRITER,"System maximum allocatable resources (n*m)\n");
+    for (int i = 0; i < rows; ++i) { writeTabRow(&BENCH_WRITER,matrix + (size_t)i*cols,cols); }
+    writerPutText(&BENCH_WRITER,"System available resources (1*m)\n");
+    writeTabRow(&BENCH_WRITER,available,cols);
+    writerFlush(&BENCH_WRITER);
+
+    free(matrix);
+    free(work);
+    free(available);
+    free(sequence);
+    return BENCH_WRITER.failed;
+}
+void writeTabRow(outputWriter *writer, const int *row, int colCount) {
+    for (int j = 0; j < colCount; ++j) {
+        writerPutInt(writer,row[j]);
+        writerPutText(writer,(j+1 < colCount) ? "\t" : "\n");
+    }
+}
+int parseIntList(const char *text, int *list, int maxCount) { // eg. '100,1000,10000'
+    int count = 0;
+    while (*text != '\0') {
+        char *end = NULL;
+        long value = strtol(text,&end,10);
+        if (end == text || value <= 0 || value > 0x7FFFFFFF || count == maxCount || (*end != ',' && *end != '\0')) { return 0; }
+        list[count++] = (int)value;
+        text = end + (*end == ',');
+    }
+    return count;
+}
+int parseWorkloadKind(const char *name, int nameLength) {
+    const char *names[] = {"safe","unsafe","barely"}; // Indexed by WORKLOAD_*
+    for (int i = 0; i < 3; ++i) {
+        if ((int)strlen(names[i]) == nameLength && strncmp(name,names[i],(size_t)nameLength) == 0) { return i; }
+    }
+    return -1;
+}
+const char *workloadKindName(int kind) {
+    return (kind == WORKLOAD_UNSAFE) ? "unsafe" : ((kind == WORKLOAD_BARELY) ? "barely" : "safe");
+}
+double nowSeconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return (double)now.tv_sec + (double)now.tv_nsec*1e-9;
+}
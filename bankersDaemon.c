@@ -0,0 +1,415 @@
+///// Alex Tregub
+///// CS33211-001
+///// Banker's Algorithm admission-control daemon
+///// ===========
+///// v1.19.5
+///// Loads one system state (text or binary snapshot) and answers request,
+/////     release, add and query frames (see bankersProto.h) from local clients
+/////     over a Unix domain socket, so services ask 'may I take these
+/////     resources?' without starting a process per question.
+/////     Changes are serialized by one writer lock. After every granted change
+/////     the writer publishes an immutable snapshot (epoch, safe sequence,
+/////     available, and a state copy once headroom is asked for), and
+/////     read-only queries answer from the newest snapshot
+/////     without taking the lock, so readers never wait for writers (or the
+/////     other way round). A snapshot is only reused once no reader holds it.
+///// - Compile via > ./buildScript.sh
+///// - Run via > ./bankersDaemon [options] SOCKET INPUT (stop with SIGINT/SIGTERM, prints served counts)
+/////     - Option -w N : worker threads, each serving one client connection at a time (default 8)
+/////     - Option -p, -j N, -k KERNELS, -z STORAGE, -n : as in bankersAlgo (-n keeps 16-bit copies for request re-checks)
+///// - Load test via > ./bankersLoad SOCKET (see bankersLoad.c)
+///// ===========
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "bankersLib.h"
+#include "bankersIO.h"
+#include "bankersProto.h"
+
+#define DAEMON_MAX_WORKERS 1024 // Upper limit for -w
+#define DAEMON_BACKLOG 256 // Pending connections queued by listen
+
+typedef struct orderCopy { // Published copy of one safe sequence version, shared by every snapshot taken while it is unchanged. Only the writer touches it
+    int refs; // Snapshot slots pointing here
+    unsigned int version; // bankerOrderVersion when copied
+    int queued;
+    int capacity; // Ints allocated in order
+    int32_t *order;
+} orderCopy;
+
+typedef struct stateSnapshot { // Immutable while published or held, readers reply straight from it
+    int refs; // Readers holding snapshot (atomic)
+    uint32_t epoch;
+    int rows;
+    int cols;
+    int isSafe;
+    orderCopy *order;
+    int32_t *available; // cols values
+    bankerState *state; // Copy for PROTO_HEADROOM (bankerHeadroom only reads it), NULL until HEADROOM_COPIES is set or if copy failed
+} stateSnapshot;
+
+bankerState *DAEMON_STATE = NULL; // Only used with WRITER_LOCK held (after startup)
+pthread_mutex_t WRITER_LOCK = PTHREAD_MUTEX_INITIALIZER;
+uint32_t EPOCH = 0; // Bumped by every granted change (writer only)
+int HEADROOM_COPIES = 0; // 1 once a HEADROOM frame arrived, from then on every publish copies the state (writer only)
+int COL_COUNT = 0; // Resources, fixed once loaded
+int SAFETY_THREADS = 1;
+stateSnapshot *SNAPSHOTS = NULL; // Workers + 2 slots: one held per worker, the current one, and one to fill
+int SNAPSHOT_COUNT = 0;
+orderCopy *ORDER_COPIES = NULL; // Snapshot slots + 1
+int ORDER_COPY_COUNT = 0;
+stateSnapshot *CURRENT_SNAPSHOT = NULL; // Newest published snapshot (atomic)
+int LISTEN_FD = -1;
+int *CLIENT_FDS = NULL; // Connection served by each worker, -1 if none (atomic, shut down on stop)
+int STOPPING = 0; // 1 once a stop signal arrived (atomic)
+unsigned long long SERVED[PROTO_OP_COUNT]; // Frames answered per op (atomic), index 0 counts bad frames
+
+void *serveClients(void*); // Worker thread: accepts a connection, answers its frames until it closes, repeats. Takes: worker index. Returns NULL
+int handleFrame(int,const protoHeader*,int32_t*,int,void**,size_t*); // Applies or answers one request frame and sends its reply. Params: fd,header,payload,readResult(FRAME_OK or FRAME_TOO_LARGE),workspace(updated, bankerHeadroom scratch of worker),workspaceBytes(updated). Returns FRAME_OK or FRAME_CLOSED
+int publishSnapshot(void); // Writer lock held: fills a free snapshot slot from state (sequence copied only if its version changed, state copied once headroom is used) and makes it current. Returns 0 if success, 1 if sequence copy could not be allocated
+stateSnapshot *acquireSnapshot(void); // Takes a ref on the current snapshot (lock-free). Returns snapshot
+void releaseSnapshot(stateSnapshot*); // Drops ref. Takes: snapshot
+int openListenSocket(const char*); // Binds and listens on path (stale socket file replaced, live one refused). Takes: path. Returns fd, -1 if failed
+int loadDaemonState(const char*,int,int); // Loads first snapshot of input into DAEMON_STATE and checks it. Params: inputPath,flags,storageMode. Returns 0 if success, 1 if failed (error printed)
+
+
+
+int main(int argc, char *argv[]) {
+    //// Parse options, socket and input are the last two non-option arguments
+    int workerCount = 8;
+    int flags = 0;
+    int serialOrder = 1; // -j without -p uses rounds order, as in bankersAlgo
+    char *kernelName = "auto";
+    char *storageName = "auto";
+    char *paths[2] = {NULL,NULL};
+    int pathCount = 0;
+    for (int i = 1; i < argc; ++i) {
+        int hasValue = (i+1 < argc);
+        if (strcmp(argv[i],"-w") == 0 && hasValue) { workerCount = atoi(argv[++i]); }
+        else if (strcmp(argv[i],"-p") == 0) { flags |= BANKER_LOWEST_FIRST; }
+        else if (strcmp(argv[i],"-j") == 0 && hasValue) { SAFETY_THREADS = atoi(argv[++i]); serialOrder = 0; }
+        else if (strcmp(argv[i],"-k") == 0 && hasValue) { kernelName = argv[++i]; }
+        else if (strcmp(argv[i],"-z") == 0 && hasValue) { storageName = argv[++i]; }
+        else if (strcmp(argv[i],"-n") == 0) { flags |= BANKER_NARROW; }
+        else if (argv[i][0] == '-') { printf("ERROR : Unknown option (%s).\n",argv[i]); return 1; }
+        else if (pathCount < 2) { paths[pathCount++] = argv[i]; }
+        else { printf("ERROR : Only a socket path and an input file are expected (%s).\n",argv[i]); return 1; }
+    }
+    int storageMode = parseStorageMode(storageName);
+    if (pathCount != 2) { printf("ERROR : Daemon needs a socket path and an input file (SOCKET INPUT).\n"); return 1; }
+    if (workerCount < 1 || workerCount > DAEMON_MAX_WORKERS) { printf("ERROR : Worker count must be 1 to %d.\n",DAEMON_MAX_WORKERS); return 1; }
+    if (SAFETY_THREADS < 1 || SAFETY_THREADS > BANKER_MAX_THREADS) { printf("ERROR : Thread count must be 1 to %d.\n",BANKER_MAX_THREADS); return 1; }
+    if (storageMode == -1) { printf("ERROR : Storage (%s) unknown (auto, dense, sparse).\n",storageName); return 1; }
+    if (bankerSelectKernels(kernelName)) { printf("ERROR : Row kernels (%s) unknown or not supported by this cpu (auto, scalar, sse2, avx2).\n",kernelName); return 1; }
+    if (!serialOrder && !(flags & BANKER_LOWEST_FIRST)) { flags |= BANKER_ROUNDS; }
+    printf("INFO : Bankers Daemon version 1.19.5\n");
+
+    //// Load state, then publish first snapshot
+    if (loadDaemonState(paths[1],flags,storageMode)) { return 1; }
+    SNAPSHOT_COUNT = workerCount + 2;
+    ORDER_COPY_COUNT = SNAPSHOT_COUNT + 1;
+    SNAPSHOTS = (stateSnapshot*)calloc((size_t)SNAPSHOT_COUNT,sizeof(stateSnapshot));
+    ORDER_COPIES = (orderCopy*)calloc((size_t)ORDER_COPY_COUNT,sizeof(orderCopy));
+    CLIENT_FDS = (int*)malloc(sizeof(int)*(size_t)workerCount);
+    int failed = (SNAPSHOTS == NULL || ORDER_COPIES == NULL || CLIENT_FDS == NULL);
+    for (int i = 0; i < SNAPSHOT_COUNT && !failed; ++i) {
+        SNAPSHOTS[i].available = (int32_t*)malloc(sizeof(int32_t)*(size_t)COL_COUNT);
+        failed = (SNAPSHOTS[i].available == NULL);
+    }
+    if (failed || publishSnapshot()) {
+        printf("ERROR : Unable to allocate snapshots.\n");
+        return 1;
+    }
+
+    //// Signals go to main thread only (sigwait), workers never see them
+    sigset_t stopSignals;
+    sigemptyset(&stopSignals);
+    sigaddset(&stopSignals,SIGINT);
+    sigaddset(&stopSignals,SIGTERM);
+    pthread_sigmask(SIG_BLOCK,&stopSignals,NULL);
+    signal(SIGPIPE,SIG_IGN);
+
+    int loadedSafe = CURRENT_SNAPSHOT->isSafe; // Read before workers may replace it
+    LISTEN_FD = openListenSocket(paths[0]);
+    if (LISTEN_FD == -1) { return 1; } // Error printed
+    pthread_t *workers = (pthread_t*)malloc(sizeof(pthread_t)*(size_t)workerCount);
+    int started = 0;
+    for (int w = 0; w < workerCount && workers != NULL; ++w) {
+        CLIENT_FDS[w] = -1;
+        if (pthread_create(&workers[w],NULL,serveClients,(void*)(intptr_t)w) != 0) { break; }
+        ++started;
+    }
+    if (started == 0) {
+        printf("ERROR : Unable to start worker threads.\n");
+        close(LISTEN_FD);
+        unlink(paths[0]);
+        return 1;
+    }
+    printf("INFO : Serving %s on (%s) with %d worker(s), state is %s.\n",paths[1],paths[0],started,loadedSafe ? "safe" : "not safe");
+    fflush(stdout);
+
+    //// Wait for stop, then wake every worker (accept and open connections) and join
+    int received = 0;
+    sigwait(&stopSignals,&received);
+    __atomic_store_n(&STOPPING,1,__ATOMIC_SEQ_CST);
+    shutdown(LISTEN_FD,SHUT_RDWR);
+    for (int w = 0; w < started; ++w) { // A worker that stores its fd after this sees STOPPING itself
+        int fd = __atomic_load_n(&CLIENT_FDS[w],__ATOMIC_SEQ_CST);
+        if (fd != -1) { shutdown(fd,SHUT_RDWR); }
+    }
+    for (int w = 0; w < started; ++w) { pthread_join(workers[w],NULL); }
+    close(LISTEN_FD);
+    unlink(paths[0]);
+
+    printf("OUTPUT : Stopped after epoch %u: info %llu, request %llu, release %llu, add %llu, query %llu, available %llu, headroom %llu, bad %llu frames.\n",EPOCH,
+        SERVED[PROTO_INFO],SERVED[PROTO_REQUEST],SERVED[PROTO_RELEASE],SERVED[PROTO_ADD],SERVED[PROTO_QUERY],SERVED[PROTO_AVAILABLE],SERVED[PROTO_HEADROOM],SERVED[0]);
+    for (int i = 0; i < SNAPSHOT_COUNT; ++i) {
+        free(SNAPSHOTS[i].available);
+        bankerDestroy(SNAPSHOTS[i].state);
+    }
+    for (int i = 0; i < ORDER_COPY_COUNT; ++i) { free(ORDER_COPIES[i].order); }
+    free(SNAPSHOTS);
+    free(ORDER_COPIES);
+    free(CLIENT_FDS);
+    free(workers);
+    bankerDestroy(DAEMON_STATE);
+    return 0;
+}
+
+
+
+//// Function definitions
+void *serveClients(void *arg) {
+    int worker = (int)(intptr_t)arg;
+    uint32_t capacity = sizeof(int32_t)*(uint32_t)COL_COUNT; // Largest request payload (one vector)
+    int32_t *payload = (int32_t*)malloc(capacity);
+    void *workspace = NULL; // Headroom scratch, only grows (snapshot copies grow with ADD)
+    size_t workspaceBytes = 0;
+    while (payload != NULL && !__atomic_load_n(&STOPPING,__ATOMIC_SEQ_CST)) {
+        int fd = accept(LISTEN_FD,NULL,NULL);
+        if (fd == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) { continue; }
+            break; // Listening socket shut down (stop), or fatal
+        }
+        __atomic_store_n(&CLIENT_FDS[worker],fd,__ATOMIC_SEQ_CST);
+        if (!__atomic_load_n(&STOPPING,__ATOMIC_SEQ_CST)) {
+            protoHeader header;
+            int readResult;
+            while ((readResult = readFrame(fd,&header,payload,capacity)) != FRAME_CLOSED) {
+                if (handleFrame(fd,&header,payload,readResult,&workspace,&workspaceBytes) != FRAME_OK) { break; }
+            }
+        }
+        __atomic_store_n(&CLIENT_FDS[worker],-1,__ATOMIC_SEQ_CST);
+        close(fd);
+    }
+    free(payload);
+    free(workspace);
+    return NULL;
+}
+int handleFrame(int fd, const protoHeader *header, int32_t *payload, int readResult, void **workspace, size_t *workspaceBytes) {
+    protoHeader reply = {0,header->op,0,header->process,0};
+    int op = header->op;
+    int isWrite = (op == PROTO_REQUEST || op == PROTO_RELEASE || op == PROTO_ADD);
+    uint32_t expected = isWrite ? sizeof(int32_t)*(uint32_t)COL_COUNT : 0; // Only writes carry a vector
+    if (readResult != FRAME_OK || op < 1 || op >= PROTO_OP_COUNT || header->length != expected) {
+        reply.status = PROTO_BAD_FRAME;
+        stateSnapshot *snapshot = acquireSnapshot(); // Held while epoch is read, so the writer cannot recycle the slot meanwhile
+        reply.epoch = snapshot->epoch;
+        releaseSnapshot(snapshot);
+        __atomic_add_fetch(&SERVED[0],1,__ATOMIC_RELAXED);
+        return sendFrame(fd,&reply,NULL);
+    }
+    __atomic_add_fetch(&SERVED[op],1,__ATOMIC_RELAXED);
+
+    if (isWrite) { // Serialized, state and epoch only change here
+        pthread_mutex_lock(&WRITER_LOCK);
+        int result;
+        if (op == PROTO_REQUEST) { result = bankerRequest(DAEMON_STATE,header->process,(const int*)payload); }
+        else if (op == PROTO_RELEASE) { result = bankerRelease(DAEMON_STATE,header->process,(const int*)payload); }
+        else {
+            result = bankerAddProcess(DAEMON_STATE,(const int*)payload);
+            if (result == BANKER_FULL) { // Move into state with double the rows (and entries), as bankersAlgo stream mode does
+                bankerState *old = DAEMON_STATE;
+                bankerState *grown = bankerIsSparse(old) ? bankerCreateSparse(2*bankerRowCapacity(old),COL_COUNT,2*bankerEntries(old)+COL_COUNT,bankerFlags(old))
+                                                         : bankerCreate(2*bankerRowCapacity(old),COL_COUNT,bankerFlags(old));
+                if (grown != NULL) {
+                    bankerSetThreads(grown,SAFETY_THREADS);
+                    bankerCopy(grown,old);
+                    bankerDestroy(old);
+                    DAEMON_STATE = grown;
+                    result = bankerAddProcess(DAEMON_STATE,(const int*)payload);
+                }
+            }
+            reply.process = (result == BANKER_OK) ? bankerRows(DAEMON_STATE) - 1 : -1;
+        }
+        if (result == BANKER_OK) {
+            ++EPOCH;
+            if (publishSnapshot()) { fprintf(stderr,"ERROR : Unable to publish snapshot for epoch %u, readers see an older epoch.\n",EPOCH); }
+        }
+        reply.epoch = EPOCH;
+        pthread_mutex_unlock(&WRITER_LOCK);
+        reply.status = (int16_t)result;
+        return sendFrame(fd,&reply,NULL);
+    }
+
+    // Read-only, answered from snapshot without the writer lock (held until reply is sent, so slot is not reused meanwhile)
+    stateSnapshot *snapshot = acquireSnapshot();
+    if (op == PROTO_HEADROOM && snapshot->state == NULL) { // First headroom read: copies start now, current epoch republished with one
+        releaseSnapshot(snapshot);
+        pthread_mutex_lock(&WRITER_LOCK);
+        HEADROOM_COPIES = 1;
+        if (CURRENT_SNAPSHOT->state == NULL && publishSnapshot()) { fprintf(stderr,"ERROR : Unable to publish snapshot for epoch %u, readers see an older epoch.\n",EPOCH); }
+        pthread_mutex_unlock(&WRITER_LOCK);
+        snapshot = acquireSnapshot(); // Still without a copy if it could not be allocated, answered BANKER_INVALID
+    }
+    int result;
+    reply.epoch = snapshot->epoch;
+    if (op == PROTO_INFO) {
+        int32_t info[4] = {PROTO_VERSION,snapshot->rows,snapshot->cols,snapshot->isSafe};
+        reply.process = snapshot->rows;
+        reply.length = sizeof(info);
+        result = sendFrame(fd,&reply,info);
+    } else if (op == PROTO_QUERY) {
+        reply.status = (int16_t)snapshot->isSafe;
+        reply.process = snapshot->order->queued;
+        reply.length = sizeof(int32_t)*(uint32_t)snapshot->order->queued;
+        result = sendFrame(fd,&reply,snapshot->order->order);
+    } else if (op == PROTO_AVAILABLE) {
+        reply.length = sizeof(int32_t)*(uint32_t)snapshot->cols;
+        result = sendFrame(fd,&reply,snapshot->available);
+    } else { // PROTO_HEADROOM, request payload buffer (cols ints) reused for the row
+        size_t needed = (snapshot->state == NULL || header->process < 0) ? 0 : bankerHeadroomWorkspace(snapshot->state,header->process);
+        if (needed > *workspaceBytes) { // Too small afterwards if this fails, answered BANKER_INVALID
+            void *grown = realloc(*workspace,needed);
+            if (grown != NULL) {
+                *workspace = grown;
+                *workspaceBytes = needed;
+            }
+        }
+        int status = (snapshot->state == NULL || header->process < 0) ? BANKER_INVALID : bankerHeadroom(snapshot->state,header->process,(int*)payload,*workspace,*workspaceBytes); // -1 (all rows) would not fit a reply
+        reply.status = (int16_t)status;
+        reply.length = (status == BANKER_INVALID) ? 0 : sizeof(int32_t)*(uint32_t)snapshot->cols;
+        result = sendFrame(fd,&reply,payload);
+    }
+    releaseSnapshot(snapshot);
+    return result;
+}
+int publishSnapshot(void) { // A free slot always exists: each worker holds at most one snapshot, plus the current one
+    stateSnapshot *current = CURRENT_SNAPSHOT; // Only the writer stores it
+    stateSnapshot *slot = NULL;
+    for (int i = 0; i < SNAPSHOT_COUNT && slot == NULL; ++i) {
+        if (&SNAPSHOTS[i] != current && __atomic_load_n(&SNAPSHOTS[i].refs,__ATOMIC_SEQ_CST) == 0) { slot = &SNAPSHOTS[i]; }
+    }
+    if (slot->order != NULL) { // Slot recycled, its sequence copy may become free
+        --slot->order->refs;
+        slot->order = NULL;
+    }
+
+    // Sequence only changes on re-sequencing requests and adds, so most publishes share the current copy
+    orderCopy *order = (current != NULL) ? current->order : NULL;
+    unsigned int version = bankerOrderVersion(DAEMON_STATE);
+    if (order == NULL || order->version != version) {
+        order = NULL;
+        for (int i = 0; i < ORDER_COPY_COUNT && order == NULL; ++i) {
+            if (ORDER_COPIES[i].refs == 0) { order = &ORDER_COPIES[i]; }
+        }
+        int queued = bankerQueued(DAEMON_STATE);
+        if (order->capacity < queued) { // Grows with added processes
+            int capacity = 2*queued;
+            int32_t *grown = (int32_t*)realloc(order->order,sizeof(int32_t)*(size_t)capacity);
+            if (grown == NULL) { return 1; }
+            order->order = grown;
+            order->capacity = capacity;
+        }
+        memcpy(order->order,bankerOrder(DAEMON_STATE),sizeof(int32_t)*(size_t)queued);
+        order->queued = queued;
+        order->version = version;
+    }
+    ++order->refs;
+    slot->order = order;
+    slot->epoch = EPOCH;
+    slot->rows = bankerRows(DAEMON_STATE);
+    slot->cols = COL_COUNT;
+    slot->isSafe = bankerIsSafe(DAEMON_STATE);
+    memcpy(slot->available,bankerAvailable(DAEMON_STATE),sizeof(int32_t)*(size_t)COL_COUNT);
+    if (HEADROOM_COPIES && (slot->state == NULL || bankerCopy(slot->state,DAEMON_STATE) != BANKER_OK)) { // Slot copy reused while it fits (ADD may outgrow it)
+        bankerDestroy(slot->state);
+        slot->state = bankerClone(DAEMON_STATE);
+    }
+    __atomic_store_n(&CURRENT_SNAPSHOT,slot,__ATOMIC_SEQ_CST); // Contents visible to any reader that loads this ptr
+    return 0;
+}
+stateSnapshot *acquireSnapshot(void) { // Ref taken before re-checking current, so the writer (which checks refs after replacing current) never reuses a slot being read
+    for (;;) {
+        stateSnapshot *snapshot = __atomic_load_n(&CURRENT_SNAPSHOT,__ATOMIC_SEQ_CST);
+        __atomic_add_fetch(&snapshot->refs,1,__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&CURRENT_SNAPSHOT,__ATOMIC_SEQ_CST) == snapshot) { return snapshot; }
+        __atomic_sub_fetch(&snapshot->refs,1,__ATOMIC_SEQ_CST); // Replaced meanwhile (slot may be refilling), try newest
+    }
+}
+void releaseSnapshot(stateSnapshot *snapshot) {
+    __atomic_sub_fetch(&snapshot->refs,1,__ATOMIC_SEQ_CST);
+}
+int openListenSocket(const char *path) {
+    struct sockaddr_un address;
+    memset(&address,0,sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) { printf("ERROR : Socket path (%s) too long.\n",path); return -1; }
+    strcpy(address.sun_path,path);
+    int probe = connectSocket(path);
+    if (probe != -1) { // Another daemon answers there, keep it
+        close(probe);
+        printf("ERROR : Socket (%s) is in use by another daemon.\n",path);
+        return -1;
+    }
+    unlink(path); // Stale file of a stopped daemon
+    int fd = socket(AF_UNIX,SOCK_STREAM,0);
+    if (fd == -1 || bind(fd,(struct sockaddr*)&address,sizeof(address)) == -1 || listen(fd,DAEMON_BACKLOG) == -1) {
+        printf("ERROR : Cannot listen on socket (%s): %s.\n",path,strerror(errno));
+        if (fd != -1) { close(fd); }
+        return -1;
+    }
+    return fd;
+}
+int loadDaemonState(const char *inputPath, int flags, int storageMode) { // Same loading as bankersAlgo -i, binary records copied (grants update the state)
+    inputReader reader;
+    if (openInputReader(&reader,inputPath)) { printf("ERROR : File (%s) does not exist or cannot be opened.\n",inputPath); return 1; }
+    int rows = 0;
+    int cols = 0;
+    int failed = 0;
+    if (readerIsBinary(&reader)) {
+        binaryView view;
+        int badRow = 0;
+        failed = (mapBinarySnapshot(&reader,&view) || checkBinaryNeed(&view,&badRow) != BINARY_NEED_OK); // Same records rejected as by bankersAlgo
+        if (!failed) {
+            rows = view.rowCount;
+            cols = view.colCount;
+            DAEMON_STATE = bankerCreate(rows,cols,flags);
+            failed = (DAEMON_STATE == NULL || bankerLoad(DAEMON_STATE,rows,cols,view.alloc,view.max,view.avail,view.rowStride) != BANKER_OK);
+        }
+    } else {
+        int readResult = 0;
+        failed = (readTextHeader(&reader,&rows,&cols) != READ_OK);
+        if (!failed) { DAEMON_STATE = loadTextState(&reader,rows,cols,flags,storageMode,&readResult); }
+        failed = failed || DAEMON_STATE == NULL || readResult != 0 || bankerEndLoad(DAEMON_STATE) != BANKER_OK;
+    }
+    if (failed) {
+        if (reader.errorKind != READ_OK) { printf("ERROR : File (%s) is not a valid snapshot (line %li, column %li: %s).\n",inputPath,reader.errorLine,reader.errorColumn,readerErrorText(reader.errorKind)); }
+        else { printf("ERROR : File (%s) is not a valid snapshot, or its state could not be allocated.\n",inputPath); }
+        closeInputReader(&reader);
+        return 1;
+    }
+    closeInputReader(&reader);
+    COL_COUNT = cols;
+    bankerSetThreads(DAEMON_STATE,SAFETY_THREADS);
+    bankerCheck(DAEMON_STATE);
+    printf("INFO : Loaded %i processes x %i resources (%s storage).\n",rows,cols,bankerIsSparse(DAEMON_STATE) ? "sparse" : "dense");
+    return 0;
+}
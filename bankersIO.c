@@ -0,0 +1,649 @@
+///// Alex Tregub
+///// CS33211-001
+///// Banker's Algorithm input/output, see bankersIO.h
+///// ===========
+///// v1.18.0
+///// - mmap (or 1MB block) reader with hand-written int scanner, binary record mapping
+///// - 1MB buffered result writer, output modes (full, diff, sequence, verdict, json, csv)
+///// - Text loader picks dense or sparse bankerState (non-zero pre-scan of mapped input)
+///// - Phase marks and written byte count for --stats (BANKER_STATS)
+///// - Optional priority/weight section after the available array (-q)
+///// ===========
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <stdint.h>
+#include <time.h>
+#include "bankersIO.h"
+
+#if BANKER_STATS
+runStats RUN_STATS; // Disabled until statsStart
+static double statsClock(void); // Returns monotonic clock in seconds
+#endif
+
+
+
+int openInputReader(inputReader *reader, const char *path) { // Regular files are mapped whole (no copy), anything else read in blocks
+    reader->data = NULL;
+    reader->pos = 0;
+    reader->len = 0;
+    reader->base = 0;
+    reader->lineStart = 0;
+    reader->line = 1;
+    reader->errorLine = 0;
+    reader->errorColumn = 0;
+    reader->errorKind = READ_OK;
+    reader->isMapped = 0;
+    reader->atEof = 0;
+    reader->fd = (strcmp(path,"-") == 0) ? STDIN_FILENO : open(path,O_RDONLY);
+    if (reader->fd == -1) { return 1; }
+
+    struct stat fileInfo;
+    if (fstat(reader->fd,&fileInfo) == 0 && S_ISREG(fileInfo.st_mode) && fileInfo.st_size > 0) { // Map whole file, pages are loaded on demand (files larger than RAM ok)
+        void *mapped = mmap(NULL,(size_t)fileInfo.st_size,PROT_READ|PROT_WRITE,MAP_PRIVATE,reader->fd,0); // Private copy-on-write, binary arrays can be updated in place
+        if (mapped != MAP_FAILED) {
+            madvise(mapped,(size_t)fileInfo.st_size,MADV_SEQUENTIAL); // Single forward pass, allow aggressive read-ahead
+            reader->data = (char*)mapped;
+            reader->len = (size_t)fileInfo.st_size;
+            reader->isMapped = 1;
+            reader->atEof = 1; // Nothing more to read
+            return 0;
+        }
+    }
+    reader->data = (char*)malloc(READER_BLOCK_SIZE); // Fall back to block reads (pipes, stdin, empty files, failed maps)
+    if (reader->data == NULL) {
+        if (reader->fd != STDIN_FILENO) { close(reader->fd); }
+        reader->fd = -1;
+        return 1;
+    }
+    return 0;
+}
+void closeInputReader(inputReader *reader) { // Releases mapping or buffer, then file
+    if (reader->data != NULL) {
+        if (reader->isMapped) { munmap(reader->data,reader->len); } 
+        else { free(reader->data); }
+        reader->data = NULL;
+    }
+    if (reader->fd != -1 && reader->fd != STDIN_FILENO) { close(reader->fd); }
+    reader->fd = -1;
+}
+int readerFill(inputReader *reader) { // Keeps unread tail, appends next block after it
+    if (reader->atEof) { return 0; }
+    size_t unread = reader->len - reader->pos;
+    memmove(reader->data,reader->data+reader->pos,unread);
+    reader->base += reader->pos;
+    reader->pos = 0;
+    reader->len = unread;
+    ssize_t got = 0;
+    do { got = read(reader->fd,reader->data+reader->len,READER_BLOCK_SIZE-reader->len); } while (got == -1 && errno == EINTR);
+    if (got <= 0) { reader->atEof = 1; return 0; } // End of file (read errors treated as end, reported as missing values)
+    reader->len += (size_t)got;
+    return (int)got;
+}
+int readerNextInt(inputReader *reader, int *value) { // Whitespace (tabs, spaces, newlines) skipped, then digits accumulated directly
+    char c = 0;
+    for (;;) { // Skip whitespace, counting lines for error positions
+        if (reader->pos == reader->len && readerFill(reader) == 0) { return READ_END; }
+        c = reader->data[reader->pos];
+        if (c == '\n') { ++reader->line; reader->lineStart = reader->base + reader->pos + 1; } 
+        else if (c != ' ' && c != '\t' && c != '\r') { break; }
+        ++reader->pos;
+    }
+
+    reader->errorLine = reader->line; // Token start, kept if token is bad
+    reader->errorColumn = (long)(reader->base + reader->pos - reader->lineStart) + 1;
+    if (c == '-') { reader->errorKind = READ_NEGATIVE; return READ_NEGATIVE; }
+    if (c < '0' || c > '9') { reader->errorKind = READ_NOT_NUMBER; return READ_NOT_NUMBER; }
+
+    long long val = 0; // Wider than int, overflow checked per digit
+    for (;;) {
+        val = val*10 + (c - '0');
+        if (val > 0x7FFFFFFF) { reader->errorKind = READ_TOO_LARGE; return READ_TOO_LARGE; }
+        ++reader->pos;
+        if (reader->pos == reader->len && readerFill(reader) == 0) { break; } // Token ends at end of file
+        c = reader->data[reader->pos];
+        if (c < '0' || c > '9') { break; }
+    }
+    if (reader->pos < reader->len && c != ' ' && c != '\t' && c != '\r' && c != '\n') { reader->errorKind = READ_NOT_NUMBER; return READ_NOT_NUMBER; } // Eg '3.5' or '4x'
+    *value = (int)val;
+    return READ_OK;
+}
+const char *readerErrorText(int errorKind) { // Human readable reader error
+    if (errorKind == READ_NEGATIVE) { return "negative value"; }
+    if (errorKind == READ_NOT_NUMBER) { return "not a non-negative integer"; }
+    if (errorKind == READ_TOO_LARGE) { return "value too large"; }
+    if (errorKind == READ_MISSING) { return "missing value (end of file)"; }
+    return "no error";
+}
+void skipReadLine(inputReader *reader) { // Skips a line (ending with \n), memchr over buffer instead of per-char reads
+    for (;;) {
+        if (reader->pos == reader->len && readerFill(reader) == 0) { return; } // End of file, nothing to skip
+        char *newline = memchr(reader->data+reader->pos,'\n',reader->len-reader->pos);
+        if (newline != NULL) { // Next read is past newline
+            reader->pos = (size_t)(newline - reader->data) + 1;
+            ++reader->line;
+            reader->lineStart = reader->base + reader->pos;
+            return;
+        }
+        reader->pos = reader->len; // Whole buffer is within line
+    }
+}
+int readRowValues(inputReader *reader, int *row, int colCount) { // Values scanned straight into row, line breaks not required between rows
+    for (int j = 0; j < colCount; ++j) {
+        int readResult = readerNextInt(reader,&row[j]);
+        if (readResult != READ_OK) { // Invalid read detected, will not continue reading. Position of token already stored
+            if (readResult == READ_END) { // Missing value, report at end of file
+                reader->errorKind = READ_MISSING;
+                reader->errorLine = reader->line;
+                reader->errorColumn = (long)(reader->base + reader->pos - reader->lineStart) + 1;
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
+int readTabSep2dArray(inputReader *reader, int ** dataArray, int rowCount, int colCount) { // Read tab separated array into 2d array of known size
+    for (int i = 0; i < rowCount; ++i) {
+        if (readRowValues(reader,dataArray[i],colCount)) { return 1; }
+    }
+    skipReadLine(reader); // Skips rest of line after table fully read (consumes newline after final value)
+    return 0;
+}
+int readTabSep1dArray(inputReader *reader, int * dataArray, int valCount) { // Read tab separated array into 1d array of known size
+    return readTabSep2dArray(reader,&dataArray,1,valCount); // Single row
+}
+void printCurrentState(outputWriter *writer, int **maximumAllocatable,int **currentlyAllocated,int **neededAllocation,int *availableResources, int rowCount, int colCount, int selProccess) { // Writes current system state (defined by passed arrays) If selected proccess = -1, none highlighted
+    // Arbitrary output of current system state, as stored in passed array ptrs
+    writerPutText(writer,"OUTPUT : P# |  Max  | Alloc | Needs | Avail\n");
+    for (int i = 0; i < rowCount; ++i) { // Loop through all rows of arrays
+        // Highlighted proccess check (adds emphasis on proccess to-be-executed)
+        writerPutText(writer,(i == selProccess) ? "OUTPUT : >> P" : "OUTPUT : P"); // If proccess selected, will be slightly offset from other proccesses in state snapshots
+        writerPutInt(writer,i);
+        writerPutText(writer," | ");
+        
+        // Output primary arrays for every line
+        writerPutRow(writer,maximumAllocatable[i],colCount);
+        writerPutText(writer,"| ");
+        writerPutRow(writer,currentlyAllocated[i],colCount);
+        writerPutText(writer,"| ");
+        writerPutRow(writer,neededAllocation[i],colCount);
+        writerPutText(writer,"| "); // Spacer for values
+
+        // For first line of data, also output 'available' resources
+        if (i == 0) { writerPutRow(writer,availableResources,colCount); }
+        writerPutText(writer,"\n"); // Terminate line 
+    }
+}
+int parseOutputMode(const char *name) {
+    const char *names[] = {"full","diff","sequence","verdict","json","csv"}; // Indexed by OUTPUT_* value
+    for (int i = 0; i < 6; ++i) {
+        if (strcmp(name,names[i]) == 0) { return i; }
+    }
+    return -1;
+}
+void writerFlush(outputWriter *writer) { // fwrite keeps order with printf lines already in stdout buffer
+    if (writer->used > 0 && fwrite(writer->buffer,1,writer->used,writer->file) != writer->used) { writer->failed = 1; }
+#if BANKER_STATS
+    writer->written += (long long)writer->used;
+#endif
+    writer->used = 0;
+}
+void writerPutText(outputWriter *writer, const char *text) {
+    size_t len = strlen(text);
+    while (len > 0) { // Copy as much as fits, flush when full
+        size_t space = WRITER_BUFFER_SIZE - writer->used;
+        size_t chunk = (len < space) ? len : space;
+        memcpy(writer->buffer+writer->used,text,chunk);
+        writer->used += chunk;
+        text += chunk;
+        len -= chunk;
+        if (writer->used == WRITER_BUFFER_SIZE) { writerFlush(writer); }
+    }
+}
+void writerPutInt(outputWriter *writer, int value) { // Digits written backwards into scratch, then copied
+    char digits[12];
+    int pos = 12;
+    unsigned int magnitude = (value < 0) ? 0u - (unsigned int)value : (unsigned int)value;
+    do {
+        digits[--pos] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (value < 0) { digits[--pos] = '-'; }
+    if (WRITER_BUFFER_SIZE - writer->used < 12) { writerFlush(writer); }
+    memcpy(writer->buffer+writer->used,digits+pos,(size_t)(12-pos));
+    writer->used += (size_t)(12-pos);
+}
+void writerPutRow(outputWriter *writer, const int *row, int colCount) {
+    for (int j = 0; j < colCount; ++j) {
+        writerPutInt(writer,row[j]);
+        writerPutText(writer," ");
+    }
+}
+void writerPutJsonText(outputWriter *writer, const char *text) { // Escapes quote, backslash and control characters
+    char escaped[8];
+    writerPutText(writer,"\"");
+    for (; *text != '\0'; ++text) {
+        unsigned char c = (unsigned char)*text;
+        if (c == '"' || c == '\\') { escaped[0] = '\\'; escaped[1] = (char)c; escaped[2] = '\0'; }
+        else if (c < 0x20) { snprintf(escaped,sizeof(escaped),"\\u%04x",c); }
+        else { escaped[0] = (char)c; escaped[1] = '\0'; }
+        writerPutText(writer,escaped);
+    }
+    writerPutText(writer,"\"");
+}
+void writerPutCsvText(outputWriter *writer, const char *text) { // Quoted (quotes doubled) only if it holds a comma, quote or line break
+    if (strpbrk(text,",\"\r\n") == NULL) { writerPutText(writer,text); return; }
+    writerPutText(writer,"\"");
+    for (; *text != '\0'; ++text) {
+        char single[2] = {*text,'\0'};
+        writerPutText(writer,(*text == '"') ? "\"\"" : single);
+    }
+    writerPutText(writer,"\"");
+}
+void writeSnapshotResult(outputWriter *writer, int outputMode, int **maxAlloc, int **procAlloc, int **needAlloc, int *availRes, const int *finalAvail, int procCount, int resCount, const int *procOrder, int queuedCount) { // Output cost is O(rows*cols) per step only in full mode
+    int isSafe = (queuedCount == procCount);
+    if (outputMode == OUTPUT_VERDICT) { writerPutText(writer,isSafe ? "SAFE\n" : "UNSAFE\n"); return; }
+    if (outputMode == OUTPUT_SEQUENCE) {
+        if (!isSafe) { writerPutText(writer,"UNSAFE\n"); return; }
+        for (int i = 0; i < procCount; ++i) {
+            writerPutText(writer,(i == 0) ? "P" : " > P");
+            writerPutInt(writer,procOrder[i]);
+        }
+        writerPutText(writer,"\n");
+        return;
+    }
+    if (outputMode == OUTPUT_JSON) { // sequence holds every process that can finish (all of them if safe), available is after they finish
+        writerPutText(writer,isSafe ? "{\"safe\":true,\"processes\":" : "{\"safe\":false,\"processes\":");
+        writerPutInt(writer,procCount);
+        writerPutText(writer,",\"resources\":");
+        writerPutInt(writer,resCount);
+        writerPutText(writer,",\"sequence\":[");
+        for (int i = 0; i < queuedCount; ++i) {
+            if (i > 0) { writerPutText(writer,","); }
+            writerPutInt(writer,procOrder[i]);
+        }
+        writerPutText(writer,"],\"available\":[");
+        for (int j = 0; j < resCount; ++j) {
+            if (j > 0) { writerPutText(writer,","); }
+            writerPutInt(writer,finalAvail[j]);
+        }
+        writerPutText(writer,"]}\n");
+        return;
+    }
+    if (outputMode == OUTPUT_CSV) { // One row per finishing process, then one 'blocked' row per process that can never finish
+        writerPutText(writer,"step,process,status\n");
+        for (int i = 0; i < queuedCount; ++i) {
+            writerPutInt(writer,i+1);
+            writerPutText(writer,",");
+            writerPutInt(writer,procOrder[i]);
+            writerPutText(writer,",done\n");
+        }
+        if (isSafe) { return; }
+        char *finished = (char*)calloc((size_t)procCount,1); // Marks finishing processes (matrices may be sparse, so not marked in need)
+        if (finished == NULL) { writer->failed = 1; return; }
+        for (int i = 0; i < queuedCount; ++i) { finished[procOrder[i]] = 1; }
+        for (int i = 0; i < procCount; ++i) {
+            if (finished[i]) { continue; }
+            writerPutText(writer,",");
+            writerPutInt(writer,i);
+            writerPutText(writer,",blocked\n");
+        }
+        free(finished);
+        return;
+    }
+
+    // Full and diff modes, tagged like the rest of the program
+    writerPutText(writer,"OUTPUT : Initial System State:\n");
+    printCurrentState(writer,maxAlloc,procAlloc,needAlloc,availRes,procCount,resCount,-1); // Output system current state
+    if (!isSafe) { // Not every process could be queued, no process was ready for position 'queuedCount'
+        writerPutText(writer,"OUTPUT : System is not in a safe state.\n");
+        return;
+    }
+    for (int i = 0; i < procCount; ++i) { // Updates states based on queue: display state first (with queued proccess selected), and THEN update values
+        int proc = procOrder[i];
+        writerPutText(writer,"OUTPUT : Exec "); // Output 'real' execution order
+        writerPutInt(writer,i+1);
+        if (outputMode == OUTPUT_FULL) {
+            writerPutText(writer,", System state:\n");
+            printCurrentState(writer,maxAlloc,procAlloc,needAlloc,availRes,procCount,resCount,proc); // Output system current state (pre-update)
+        }
+        for (int j = 0; j < resCount; ++j) { availRes[j] += procAlloc[proc][j]; } // Updates the avail-resources for proccess which is in the ith position in queue
+        if (outputMode == OUTPUT_DIFF) { // Only the completing row (pre-update) and the new Avail
+            writerPutText(writer," >> P");
+            writerPutInt(writer,proc);
+            writerPutText(writer," | ");
+            writerPutRow(writer,maxAlloc[proc],resCount);
+            writerPutText(writer,"| ");
+            writerPutRow(writer,procAlloc[proc],resCount);
+            writerPutText(writer,"| ");
+            writerPutRow(writer,needAlloc[proc],resCount);
+            writerPutText(writer,"| ");
+            writerPutRow(writer,availRes,resCount);
+            writerPutText(writer,"\n");
+        }
+        for (int j = 0; j < resCount; ++j) { // Updating values in arrays
+            procAlloc[proc][j] = 0; // Sets the new 'currently' allocated resources to 0
+            needAlloc[proc][j] = 0; // No longer needs any allocated resources, process has completed
+            maxAlloc[proc][j] = 0; // Process no longer running, thus dropped
+        }
+    }
+    if (outputMode == OUTPUT_FULL) {
+        writerPutText(writer,"OUTPUT : Final System State:\n");
+        printCurrentState(writer,maxAlloc,procAlloc,needAlloc,availRes,procCount,resCount,-1); // Final system state displayed (available resources updated, all other processes zeroed)
+    }
+
+    // Outputs safe sequence summary for system state 
+    writerPutText(writer,"OUTPUT : Safe sequence displayed:\nOUTPUT : "); // 'tag' for sorting of program output
+    for (int i = 0; i < procCount; ++i) {
+        writerPutText(writer,(i == 0) ? "P" : " > P");
+        writerPutInt(writer,procOrder[i]);
+    }
+    writerPutText(writer,"\n");
+}
+void writeBatchRecord(outputWriter *writer, int outputMode, const char *inputPath, int snapshot, int rowCount, int colCount, const char *verdict, const int *order, int queued) { // Full/diff keep the tagged 'path#n RxC VERDICT' line
+    int isSafe = (strcmp(verdict,"SAFE") == 0);
+    if (outputMode == OUTPUT_JSON) {
+        writerPutText(writer,"{\"input\":");
+        writerPutJsonText(writer,inputPath);
+        writerPutText(writer,",\"snapshot\":");
+        writerPutInt(writer,snapshot);
+        if (rowCount >= 0) {
+            writerPutText(writer,",\"processes\":");
+            writerPutInt(writer,rowCount);
+            writerPutText(writer,",\"resources\":");
+            writerPutInt(writer,colCount);
+        }
+        if (order == NULL) { // Error, verdict is 'ERROR reason'
+            writerPutText(writer,",\"error\":");
+            writerPutJsonText(writer,verdict+6);
+            writerPutText(writer,"}\n");
+            return;
+        }
+        writerPutText(writer,isSafe ? ",\"safe\":true,\"sequence\":[" : ",\"safe\":false,\"sequence\":[");
+        for (int i = 0; i < queued; ++i) {
+            if (i > 0) { writerPutText(writer,","); }
+            writerPutInt(writer,order[i]);
+        }
+        writerPutText(writer,"]}\n");
+        return;
+    }
+    if (outputMode == OUTPUT_CSV) { // Header written by caller
+        writerPutCsvText(writer,inputPath);
+        writerPutText(writer,",");
+        writerPutInt(writer,snapshot);
+        writerPutText(writer,",");
+        if (rowCount >= 0) { writerPutInt(writer,rowCount); }
+        writerPutText(writer,",");
+        if (rowCount >= 0) { writerPutInt(writer,colCount); }
+        writerPutText(writer,",");
+        writerPutCsvText(writer,verdict);
+        writerPutText(writer,"\n");
+        return;
+    }
+    if (outputMode == OUTPUT_FULL || outputMode == OUTPUT_DIFF) { writerPutText(writer,"OUTPUT : "); }
+    writerPutText(writer,inputPath);
+    writerPutText(writer,"#");
+    writerPutInt(writer,snapshot);
+    writerPutText(writer," ");
+    if (rowCount >= 0) {
+        writerPutInt(writer,rowCount);
+        writerPutText(writer,"x");
+        writerPutInt(writer,colCount);
+        writerPutText(writer," ");
+    }
+    writerPutText(writer,verdict);
+    for (int i = 0; i < queued && isSafe && outputMode == OUTPUT_SEQUENCE; ++i) { // Sequence mode appends the safe sequence
+        writerPutText(writer,(i == 0) ? " P" : " > P");
+        writerPutInt(writer,order[i]);
+    }
+    writerPutText(writer,"\n");
+}
+int readSnapshotBody(inputReader *file, int **currentlyAllocated, int **maximumAllocatable, int *availableResources, int rowCount, int colCount) { // Reads everything after the header line of one snapshot
+    skipReadLine(file); // Ignore 1 line of file - after header (no data stored)
+    STATS_MARK(STATS_SETUP);
+    if (readTabSep2dArray(file,currentlyAllocated,rowCount,colCount)) { return 1; } // Read allocated resources array
+    STATS_MARK(STATS_ALLOC);
+    skipReadLine(file); // Ignore 1 line of file - after array
+    if (readTabSep2dArray(file,maximumAllocatable,rowCount,colCount)) { return 2; } // Read maximum allocatable resources array
+    STATS_MARK(STATS_MAX);
+    skipReadLine(file); // Ignore 1 line of file - after array
+    if (readTabSep1dArray(file,availableResources,colCount)) { return 3; } // Read available resources array, final entry of snapshot
+    STATS_MARK(STATS_AVAIL);
+    return 0;
+}
+int readSnapshotRows(inputReader *file, bankerState *state, int *rowBuffer, int rowCount, int colCount) { // readSnapshotBody for states without row ptrs (sparse), one reused row buffer
+    skipReadLine(file);
+    STATS_MARK(STATS_SETUP);
+    for (int i = 0; i < rowCount; ++i) {
+        if (readRowValues(file,rowBuffer,colCount)) { return 1; }
+        if (bankerLoadAllocRow(state,i,rowBuffer) != BANKER_OK) { return 4; }
+    }
+    STATS_MARK(STATS_ALLOC);
+    skipReadLine(file); // Rest of final row's line
+    skipReadLine(file);
+    for (int i = 0; i < rowCount; ++i) {
+        if (readRowValues(file,rowBuffer,colCount)) { return 2; }
+        if (bankerLoadMaxRow(state,i,rowBuffer) != BANKER_OK) { return 4; }
+    }
+    STATS_MARK(STATS_MAX);
+    skipReadLine(file);
+    skipReadLine(file);
+    if (readTabSep1dArray(file,bankerAvailable(state),colCount)) { return 3; }
+    STATS_MARK(STATS_AVAIL);
+    return 0;
+}
+int readPrioritySection(inputReader *reader, int *priority, int *weight, int rowCount) { // Only whitespace left means no section, anything else starts its comment line
+    for (;;) {
+        if (reader->pos == reader->len && readerFill(reader) == 0) { return -1; }
+        char c = reader->data[reader->pos];
+        if (c == '\n') { ++reader->line; reader->lineStart = reader->base + reader->pos + 1; }
+        else if (c != ' ' && c != '\t' && c != '\r') { break; }
+        ++reader->pos;
+    }
+    skipReadLine(reader);
+    int pair[2]; // Priority, weight
+    for (int i = 0; i < rowCount; ++i) {
+        if (readRowValues(reader,pair,2)) { return 1; }
+        priority[i] = pair[0];
+        weight[i] = pair[1];
+    }
+    skipReadLine(reader);
+    return 0;
+}
+long long countNonZeroTokens(inputReader *reader, long long stopAfter) { // Byte scan without number conversion, a token counts if any digit is 1-9 (comment lines add at most a few)
+    if (!reader->isMapped) { return -1; } // Block reads cannot look ahead
+    long long count = 0;
+    unsigned int nonZero = 0; // Current token has a non-zero digit
+    const unsigned char *data = (const unsigned char*)reader->data;
+    for (size_t block = reader->pos; block < reader->len && count <= stopAfter; block += 4096) { // Limit checked per block, inner loop branch-free
+        size_t blockEnd = (reader->len - block < 4096) ? reader->len : block + 4096;
+        for (size_t i = block; i < blockEnd; ++i) {
+            unsigned int isDigit = (unsigned int)(data[i] - '0') < 10;
+            unsigned int isNonZero = (unsigned int)(data[i] - '1') < 9;
+            count += nonZero & !isDigit; // Token ended
+            nonZero = (nonZero | isNonZero) & isDigit;
+        }
+    }
+    return count + nonZero;
+}
+bankerState *loadTextState(inputReader *reader, int rowCount, int colCount, int flags, int storageMode, int *result) { // Sparse capacity is the non-zero token count of the rest of the input, which bounds staged allocated values and entries
+    long long values = (long long)rowCount*colCount;
+    long long entries = -1; // Sparse entry capacity, -1 for dense
+    if (storageMode == STORAGE_SPARSE) {
+        entries = countNonZeroTokens(reader,0x7FFFFFFF);
+        if (entries == -1 || entries > 0x7FFFFFFF) { entries = (values < 0x7FFFFFFF) ? values : 0x7FFFFFFF; } // Unknown, one entry per value
+    } else if (storageMode == STORAGE_AUTO && values >= BANKER_SPARSE_MIN_VALUES) { // Allocated + maximum values, density measured over both
+        long long limit = 2*values/BANKER_SPARSE_DENSITY;
+        long long count = countNonZeroTokens(reader,limit);
+        if (count != -1 && count <= limit) { entries = count; }
+    }
+
+    bankerState *state = (entries == -1) ? bankerCreate(rowCount,colCount,flags) : bankerCreateSparse(rowCount,colCount,(int)entries,flags);
+    int *rowBuffer = (entries == -1) ? NULL : (int*)malloc(sizeof(int)*(size_t)colCount);
+    if (state == NULL || (entries != -1 && rowBuffer == NULL)) {
+        bankerDestroy(state);
+        free(rowBuffer);
+        *result = 5;
+        return NULL;
+    }
+    bankerBeginLoad(state,rowCount,colCount);
+    if (entries == -1) { *result = readSnapshotBody(reader,bankerAllocRows(state),bankerMaxRows(state),bankerAvailable(state),rowCount,colCount); }
+    else { *result = readSnapshotRows(reader,state,rowBuffer,rowCount,colCount); }
+    free(rowBuffer);
+    return state;
+}
+int parseStorageMode(const char *name) {
+    const char *names[] = {"auto","dense","sparse"}; // Indexed by STORAGE_* value
+    for (int i = 0; i < 3; ++i) {
+        if (strcmp(name,names[i]) == 0) { return i; }
+    }
+    return -1;
+}
+int readTextHeader(inputReader *reader, int *rowCount, int *colCount) { // Reads 'procCount resCount' and rest of header line
+    int headerRead = readerNextInt(reader,rowCount); // Leading whitespace (previous snapshot's newline) skipped
+    if (headerRead == READ_END) { return READ_END; } // No more snapshots
+    if (headerRead == READ_OK) { headerRead = readerNextInt(reader,colCount); }
+    if (headerRead == READ_END) { return READ_MISSING; }
+    if (headerRead != READ_OK) { return headerRead; }
+    if (*rowCount <= 0 || *colCount <= 0) { return READ_NOT_NUMBER; } // Zero sized snapshot
+    skipReadLine(reader); // Skip rest of header line, body starts with comment line
+    return READ_OK;
+}
+int binaryRowStride(int colCount) { // Stored row length, padded so every row starts on a 64 byte boundary
+    return (colCount + BINARY_ROW_PAD - 1) / BINARY_ROW_PAD * BINARY_ROW_PAD;
+}
+int hostIsLittleEndian(void) { // Binary blocks are used in place, only valid when host order matches
+    unsigned int probe = 1;
+    return *(unsigned char*)&probe == 1;
+}
+int readerIsBinary(inputReader *reader) { // Checks for binary magic at current position (only possible for mapped input)
+    return reader->isMapped && reader->len - reader->pos >= 4 && memcmp(reader->data+reader->pos,BINARY_MAGIC,4) == 0;
+}
+int mapBinarySnapshot(inputReader *reader, binaryView *view) { // Validates record header, points view into mapping and moves reader past record
+    if (!hostIsLittleEndian()) { return 1; } // Blocks are little-endian, no swapping done
+    if (reader->pos % BINARY_ALIGN != 0 || reader->len - reader->pos < sizeof(binaryHeader)) { return 1; } // Misaligned or truncated header
+    binaryHeader *header = (binaryHeader*)(reader->data + reader->pos);
+    uint64_t available = reader->len - reader->pos;
+    if (header->version != BINARY_VERSION || header->headerSize != sizeof(binaryHeader)) { return 1; }
+    if (header->procCount == 0 || header->procCount > 0x7FFFFFFF || header->resCount == 0 || header->resCount > 0x7FFFFFFF - BINARY_ROW_PAD) { return 1; } // Padded stride still fits an int
+    if (header->rowStride != (uint32_t)binaryRowStride((int)header->resCount) || header->recordSize > available || header->recordSize % BINARY_ALIGN != 0) { return 1; }
+    uint64_t rowBytes = (uint64_t)header->rowStride * sizeof(int);
+    if (rowBytes > header->recordSize || header->procCount > header->recordSize / rowBytes) { return 1; } // Bounded before multiplying, so matrixBytes <= recordSize
+    uint64_t matrixBytes = (uint64_t)header->procCount * rowBytes;
+    uint64_t offsets[3] = {header->allocOffset,header->maxOffset,header->needOffset};
+    for (int i = 0; i < 3; ++i) { // Every block aligned and inside record (compared against space left, sums could wrap)
+        if (offsets[i] % BINARY_ALIGN != 0 || offsets[i] < sizeof(binaryHeader) || offsets[i] > header->recordSize || matrixBytes > header->recordSize - offsets[i]) { return 1; }
+    }
+    if (header->availOffset % BINARY_ALIGN != 0 || header->availOffset < sizeof(binaryHeader) || header->availOffset > header->recordSize || rowBytes > header->recordSize - header->availOffset) { return 1; }
+
+    char *record = reader->data + reader->pos; // No values touched, pages load on first use
+    view->alloc = (int*)(record + header->allocOffset);
+    view->max = (int*)(record + header->maxOffset);
+    view->need = (int*)(record + header->needOffset);
+    view->avail = (int*)(record + header->availOffset);
+    view->rowCount = (int)header->procCount;
+    view->colCount = (int)header->resCount;
+    view->rowStride = (int)header->rowStride;
+    reader->pos += header->recordSize; // Next record (or end of file)
+    return 0;
+}
+int **binaryViewRows(const binaryView *view) { // One allocation, rows of each block in the writeSnapshotResult layout
+    size_t rows = (size_t)view->rowCount;
+    int **rowPtrs = (int**)malloc(sizeof(int*)*3*rows);
+    if (rowPtrs == NULL) { return NULL; }
+    for (size_t i = 0; i < rows; ++i) {
+        rowPtrs[i] = view->alloc + i*view->rowStride;
+        rowPtrs[rows + i] = view->max + i*view->rowStride;
+        rowPtrs[2*rows + i] = view->need + i*view->rowStride;
+    }
+    return rowPtrs;
+}
+int checkBinaryNeed(const binaryView *view, int *outputRow) { // Stored need is trusted by bankerCheckView, so it must match what bankerEndLoad would compute
+    for (int i = 0; i < view->rowCount; ++i) { // Row by row, so a huge mapping is streamed once
+        size_t rowStart = (size_t)i*view->rowStride;
+        const int *allocRow = view->alloc + rowStart;
+        const int *maxRow = view->max + rowStart;
+        const int *needRow = view->need + rowStart;
+        int negative = 0;
+        int mismatch = 0;
+        for (int j = 0; j < view->colCount; ++j) { // Flags ORed, no early exit, so the loop vectorizes
+            long long need = (long long)maxRow[j] - allocRow[j];
+            negative |= (need < 0);
+            mismatch |= (need != needRow[j]);
+        }
+        if (negative || mismatch) {
+            *outputRow = i;
+            return negative ? BINARY_NEED_NEGATIVE : BINARY_NEED_MISMATCH;
+        }
+    }
+    return BINARY_NEED_OK;
+}
+int writeBinarySnapshot(FILE *output, int **currentlyAllocated, int **maximumAllocatable, int **neededAllocation, int *availableResources, int rowCount, int colCount) { // Writes one record: header, then alloc/max/need/avail blocks each 64 byte aligned. Returns 1 if write failed
+    static const int zeroPad[BINARY_ALIGN] = {0}; // Padding source (larger than any row or block pad)
+    int stride = binaryRowStride(colCount);
+    uint64_t matrixBytes = (uint64_t)rowCount * stride * sizeof(int); // Always multiple of 64
+    binaryHeader header;
+    memset(&header,0,sizeof(header));
+    memcpy(header.magic,BINARY_MAGIC,4);
+    header.version = BINARY_VERSION;
+    header.procCount = (uint32_t)rowCount;
+    header.resCount = (uint32_t)colCount;
+    header.rowStride = (uint32_t)stride;
+    header.headerSize = sizeof(binaryHeader);
+    header.allocOffset = sizeof(binaryHeader);
+    header.maxOffset = header.allocOffset + matrixBytes;
+    header.needOffset = header.maxOffset + matrixBytes;
+    header.availOffset = header.needOffset + matrixBytes;
+    header.recordSize = header.availOffset + (uint64_t)stride*sizeof(int);
+
+    int failed = (fwrite(&header,sizeof(header),1,output) != 1);
+    int **matrices[3] = {currentlyAllocated,maximumAllocatable,neededAllocation};
+    for (int i = 0; i < 3 && !failed; ++i) {
+        for (int r = 0; r < rowCount && !failed; ++r) {
+            failed |= (fwrite(matrices[i][r],sizeof(int),(size_t)colCount,output) != (size_t)colCount);
+            failed |= (fwrite(zeroPad,sizeof(int),(size_t)(stride-colCount),output) != (size_t)(stride-colCount));
+        }
+    }
+    if (!failed) {
+        failed |= (fwrite(availableResources,sizeof(int),(size_t)colCount,output) != (size_t)colCount);
+        failed |= (fwrite(zeroPad,sizeof(int),(size_t)(stride-colCount),output) != (size_t)(stride-colCount));
+    }
+    return failed;
+}
+int writeTextSnapshot(FILE *output, int **currentlyAllocated, int **maximumAllocatable, int *availableResources, int rowCount, int colCount) { // Writes one snapshot in the tab separated layout of sampleInputFile.txt. Returns 1 if write failed
+    fprintf(output,"%i\t%i\n",rowCount,colCount);
+    fprintf(output,"System's currently allocated resources (n*m)\n");
+    for (int i = 0; i < rowCount; ++i) {
+        for (int j = 0; j < colCount; ++j) { fprintf(output,(j+1 < colCount) ? "%i\t" : "%i\n",currentlyAllocated[i][j]); }
+    }
+    fprintf(output,"System maximum allocatable resources (n*m)\n");
+    for (int i = 0; i < rowCount; ++i) {
+        for (int j = 0; j < colCount; ++j) { fprintf(output,(j+1 < colCount) ? "%i\t" : "%i\n",maximumAllocatable[i][j]); }
+    }
+    fprintf(output,"System available resources (1*m)\n");
+    for (int j = 0; j < colCount; ++j) { fprintf(output,(j+1 < colCount) ? "%i\t" : "%i\n",availableResources[j]); }
+    return ferror(output) != 0;
+}
+#if BANKER_STATS
+static double statsClock(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return (double)now.tv_sec + (double)now.tv_nsec*1e-9;
+}
+void statsStart(void) {
+    memset(&RUN_STATS,0,sizeof(RUN_STATS));
+    RUN_STATS.enabled = 1;
+    RUN_STATS.lastMark = statsClock();
+}
+void statsMark(int phase) {
+    if (!RUN_STATS.enabled) { return; }
+    double now = statsClock();
+    RUN_STATS.phaseSeconds[phase] += now - RUN_STATS.lastMark;
+    RUN_STATS.lastMark = now;
+}
+#endif
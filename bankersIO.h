@@ -0,0 +1,151 @@
+///// Alex Tregub
+///// CS33211-001
+///// Banker's Algorithm input/output (text + binary snapshot readers, result writer) shared by bankersAlgo and bankersBench
+///// ===========
+///// v1.18.0
+///// Readers and writers for the snapshot formats and output modes, kept out
+/////     of bankersLib (the library never touches files) and out of the CLI so
+/////     the benchmark harness parses and writes exactly as the CLI does.
+///// - Compiled into ./bankersAlgo and ./bankersBench by buildScript.sh / buildBenchScript.sh
+///// ===========
+#ifndef BANKERS_IO_H
+#define BANKERS_IO_H
+#include <stdio.h>
+#include <stdint.h>
+#include "bankersLib.h"
+
+#define WRITER_BUFFER_SIZE (1<<20) // Bytes of results buffered by outputWriter between writes
+#define OUTPUT_FULL 0 // Output modes (-o), full state table before every step (original output)
+#define OUTPUT_DIFF 1 // Initial table, then only the completing row and new Avail per step
+#define OUTPUT_SEQUENCE 2 // Untagged safe sequence (or UNSAFE)
+#define OUTPUT_VERDICT 3 // Untagged SAFE/UNSAFE
+#define OUTPUT_JSON 4 // One JSON object per snapshot
+#define OUTPUT_CSV 5 // CSV rows with header
+#define READER_BLOCK_SIZE (1<<20) // Bytes read per block when input cannot be memory mapped (pipes, stdin)
+#define READ_OK 0 // Reader results (returned by readerNextInt, stored as errorKind)
+#define READ_END -1
+#define READ_NEGATIVE 1
+#define READ_NOT_NUMBER 2
+#define READ_TOO_LARGE 3
+#define READ_MISSING 4
+#define STORAGE_AUTO 0 // State storage (-z): sparse when mapped text input is sparse enough (BANKER_SPARSE_*), else dense
+#define STORAGE_DENSE 1
+#define STORAGE_SPARSE 2
+#define STATS_OPEN 0 // Phases timed for --stats, each STATS_MARK adds the time since the previous mark to its phase
+#define STATS_HEADER 1
+#define STATS_SETUP 2 // State allocation (and sparse density scan)
+#define STATS_ALLOC 3 // Currently allocated array read
+#define STATS_MAX 4 // Maximum allocatable array read
+#define STATS_AVAIL 5 // Available array read
+#define STATS_NEED 6 // Need (max - alloc) and totals, bankerEndLoad/bankerLoad
+#define STATS_CHECK 7 // Safety check
+#define STATS_OUTPUT 8 // Results (or stream/what-if/headroom queries) formatted and written
+#define STATS_PHASES 9
+
+#define BINARY_MAGIC "BNKR" // First 4 bytes of every binary snapshot record
+#define BINARY_VERSION 1
+#define BINARY_ALIGN 64 // Byte alignment of records and blocks within them
+#define BINARY_ROW_PAD 16 // Ints per 64 bytes, rows padded to a multiple of this
+#define BINARY_NEED_OK 0 // checkBinaryNeed results
+#define BINARY_NEED_NEGATIVE 1 // Allocated above maximum (need would be negative)
+#define BINARY_NEED_MISMATCH 2 // Stored need differs from max - alloc (hand-edited record)
+
+typedef struct binaryHeader { // Binary snapshot record header (64 bytes, little-endian). Offsets are from record start
+    char magic[4]; // BINARY_MAGIC
+    uint32_t version; // BINARY_VERSION
+    uint32_t procCount; // Rows
+    uint32_t resCount; // Cols
+    uint32_t rowStride; // Ints stored per row (binaryRowStride(resCount)), padding is zero
+    uint32_t headerSize; // sizeof(binaryHeader)
+    uint64_t allocOffset; // procCount x rowStride currently allocated block
+    uint64_t maxOffset; // procCount x rowStride maximum allocatable block
+    uint64_t needOffset; // procCount x rowStride needed block (max - alloc, computed by converter)
+    uint64_t availOffset; // 1 x rowStride available block
+    uint64_t recordSize; // Total bytes (multiple of BINARY_ALIGN), next record starts here
+} binaryHeader;
+
+typedef struct binaryView { // Blocks of one mapped binary record, row i of a matrix starts at block + i*rowStride
+    int *alloc;
+    int *max;
+    int *need;
+    int *avail;
+    int rowCount;
+    int colCount;
+    int rowStride;
+} binaryView;
+
+typedef struct inputReader { // Input file, memory mapped when possible, otherwise read in large blocks
+    char *data; // Mapped file, or block buffer
+    size_t pos; // Next unread byte in data
+    size_t len; // Valid bytes in data
+    size_t base; // Absolute file offset of data[0] (block mode), used for columns
+    size_t lineStart; // Absolute offset of first byte of current line
+    long line; // Current line (1-based)
+    long errorLine; // Line of first bad token
+    long errorColumn; // Column of first bad token (1-based)
+    int errorKind; // READ_* result of first bad token
+    int fd; // Open file descriptor (-1 if closed)
+    int isMapped; // 1 if data is mmap'd (whole file), 0 if block buffer
+    int atEof; // 1 once block reads returned 0
+} inputReader;
+
+typedef struct outputWriter { // Results are formatted straight into one large buffer (no printf per value), written out when full or flushed
+    FILE *file;
+    size_t used;
+    int failed; // 1 once a write to file failed
+#if BANKER_STATS
+    long long written; // Bytes handed to file by writerFlush
+#endif
+    char buffer[WRITER_BUFFER_SIZE];
+} outputWriter;
+
+#if BANKER_STATS
+typedef struct runStats { // Phase times of this process, recorded only after statsStart (marks cost one branch otherwise)
+    int enabled;
+    double lastMark; // Monotonic seconds of last mark
+    double phaseSeconds[STATS_PHASES];
+} runStats;
+extern runStats RUN_STATS;
+void statsStart(void); // Enables marks, time from now is counted. Takes: nothing
+void statsMark(int); // Adds time since last mark to phase. Takes: STATS_* phase
+#define STATS_MARK(phase) statsMark(phase)
+#else
+#define STATS_MARK(phase) ((void)0)
+#endif
+
+int openInputReader(inputReader*,const char*); // Opens file for reading ('-' is stdin), mmap if regular file, block reads otherwise. Params: reader,path. Returns 0 if success, 1 if file cannot be opened
+void closeInputReader(inputReader*); // Unmaps/frees buffer and closes file. Takes: reader
+int readerFill(inputReader*); // Block mode: moves unread bytes to front of buffer, reads next block. Takes: reader. Returns bytes added (0 at end of file)
+int readerNextInt(inputReader*,int*); // Hand-written scan of next whitespace-separated non-negative int. Params: reader,outputValue. Returns READ_OK, READ_END (nothing left), or error kind (position stored in reader)
+const char *readerErrorText(int); // Text for reader error kind. Takes: errorKind
+void skipReadLine(inputReader*); // Skips forward past next newline. Takes: reader (from openInputReader(...))
+int readRowValues(inputReader*,int*,int); // Scans one row of values (line not skipped). Params: reader,outputRow,cols. Returns 0 if success, 1 if fail (position in reader)
+int readTabSep2dArray(inputReader*,int**,int,int); // Reads tab-separated 2d array of known size, then rest of final line. Params: reader,outputArray,rows,cols. Returns invalidReadFlag (0 if success, 1 if fail - position in reader)
+int readTabSep1dArray(inputReader*,int*,int); // Reads tab-separated 1d array of known size, then rest of line. Params: reader,outputArray,cols. Returns invalidReadFlag (0 if success, 1 if fail - position in reader)
+void printCurrentState(outputWriter*,int**,int**,int**,int*,int,int,int); // Writes out state of system stored in multiple arrays. Params: writer,maxAllocatable,isAllocated,needsAllocation,availableResources,rows,cols,highlightProccess(-1 if none)
+int parseOutputMode(const char*); // Takes: mode name (full, diff, sequence, verdict, json, csv). Returns OUTPUT_* value, -1 if unknown
+void writerFlush(outputWriter*); // Writes buffered bytes to file. Takes: writer
+void writerPutText(outputWriter*,const char*); // Params: writer,text
+void writerPutInt(outputWriter*,int); // Hand-written int formatting. Params: writer,value
+void writerPutRow(outputWriter*,const int*,int); // Writes each value followed by a space. Params: writer,row,cols
+void writerPutJsonText(outputWriter*,const char*); // Writes quoted, escaped JSON string. Params: writer,text
+void writerPutCsvText(outputWriter*,const char*); // Writes CSV field (quoted if needed). Params: writer,text
+void writeSnapshotResult(outputWriter*,int,int**,int**,int**,int*,const int*,int,int,const int*,int); // Writes result of one checked snapshot in output mode (full/diff modes zero completed rows). Params: writer,outputMode,maxAllocatable,isAllocated,needsAllocation,availableResources,finalAvailable,rows,cols,order,queued
+void writeBatchRecord(outputWriter*,int,const char*,int,int,int,const char*,const int*,int); // Writes one batch verdict in output mode. Params: writer,outputMode,inputPath,snapshot,rows(-1 if unknown),cols,verdict(SAFE/UNSAFE/ERROR text),order(NULL if none),queued
+int readSnapshotBody(inputReader*,int**,int**,int*,int,int); // Reads the 3 comment lines + arrays following a header. Params: reader,isAllocated,maxAllocatable,availableResources,rows,cols. Returns 0 if success, 1/2/3 if allocated/maximum/available read failed
+int readSnapshotRows(inputReader*,bankerState*,int*,int,int); // As readSnapshotBody, rows loaded through bankerLoadAllocRow/bankerLoadMaxRow. Params: reader,state(after bankerBeginLoad),rowBuffer(cols),rows,cols. Returns 0 if success, 1/2/3 if read failed, 4 if state full
+int readPrioritySection(inputReader*,int*,int*,int); // Reads optional section after the available array: comment line, then 'priority weight' per process (non-negative, negative values fail as in the arrays). Params: reader,outputPriority(rows),outputWeight(rows),rows. Returns 0 if read, -1 if input ends first (no section), 1 if read failed (position in reader)
+long long countNonZeroTokens(inputReader*,long long); // Counts tokens with a non-zero digit from reader position to end (reader not moved). Params: reader,stopAfter(scan ends once count is above). Returns count, -1 if input not mapped
+bankerState *loadTextState(inputReader*,int,int,int,int,int*); // Creates dense or sparse state for storage mode, reads body after header into it (bankerEndLoad left to caller). Params: reader,rows,cols,flags,storageMode,outputResult(0, readSnapshotRows error, 5 if alloc failed). Returns state (NULL if alloc failed)
+int parseStorageMode(const char*); // Takes: storage name (auto, dense, sparse). Returns STORAGE_* value, -1 if unknown
+int readTextHeader(inputReader*,int*,int*); // Reads text snapshot header line. Params: reader,rows,cols. Returns READ_OK, READ_END (no more snapshots) or error kind
+int binaryRowStride(int); // Ints stored per row in binary snapshots (cols padded to 16). Takes: cols
+int hostIsLittleEndian(void); // Returns 1 if host stores ints little-endian (binary snapshots usable in place)
+int readerIsBinary(inputReader*); // Returns 1 if binary snapshot magic at reader position. Takes: reader
+int mapBinarySnapshot(inputReader*,binaryView*); // Points view into mapped binary record (no parsing), advances reader past it. Params: reader,outputView. Returns 0 if success, 1 if invalid record
+int **binaryViewRows(const binaryView*); // Row ptrs into mapped blocks, alloc rows then max rows then need rows (free when done). Takes: view. Returns row ptrs (NULL if alloc failed)
+int checkBinaryNeed(const binaryView*,int*); // Verifies stored need = max - alloc (never negative), one pass over the mapped blocks. Params: view,outputRow(first bad row). Returns BINARY_NEED_* value
+int writeBinarySnapshot(FILE*,int**,int**,int**,int*,int,int); // Writes one binary record. Params: output file,isAllocated,maxAllocatable,needsAllocation,availableResources,rows,cols. Returns 1 if write failed
+int writeTextSnapshot(FILE*,int**,int**,int*,int,int); // Writes one text snapshot (sampleInputFile.txt layout). Params: output file,isAllocated,maxAllocatable,availableResources,rows,cols. Returns 1 if write failed
+
+#endif
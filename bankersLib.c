@@ -0,0 +1,1828 @@
+///// Alex Tregub
+///// CS33211-001
+///// Banker's Algorithm library, see bankersLib.h for the API
+///// ===========
+///// v1.19.2
+///// Arena layout (64 byte aligned blocks, carved by bankerLayout):
+/////     state header | row ptrs (alloc, max, need, 2 view) | alloc, max, need rows (padded to 8 ints) |
+/////     16-bit need, alloc rows (BANKER_NARROW only) | available, total, work, probe vectors |
+/////     order, candidate order, order position, pending, ready | bounds, share counts | thresholds |
+/////     priority keys, ready keys (BANKER_PRIORITY only)
+///// Sparse states (bankerCreateSparse) replace row ptrs, matrices and 16-bit rows with
+/////     row starts | entry resources, entry alloc, entry need, and size thresholds by entries
+///// BANKER_VIEW_ONLY states keep only the 2 view row ptr blocks of the dense matrix part (bankerCheckView scratch)
+///// - Worklist safety check, optional threads (rounds or serial drain), SSE2/AVX2 row kernels
+///// - What-if batches proven against the baseline sequence prefix, rest re-checked along it (per-resource leftist waiting heaps, one node per process)
+///// - Headroom (maximum safe grants): guided search for one process, one bottleneck closure sweep per resource for all
+///// - What-if/headroom scratch carved from a caller workspace (whatIfLayout/headroomLayout, same blocks as the arena), states stay read-only
+///// - Width kernels for 1..16 resources generated by macro (FIXED_WIDTHS), chosen per state from its resource count
+///// - Priority drain (BANKER_PRIORITY): ready processes in a min-heap of packed (key,process), same worklist wake-ups
+///// - Work counters (BANKER_STATS), added once per check from worklist totals so the drain loop is untouched
+///// ===========
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "bankersLib.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_KERNELS 1 // SSE2/AVX2 row kernels compiled in, chosen at runtime
+#else
+#define HAVE_X86_KERNELS 0 // Scalar row kernels only
+#endif
+
+#define ARENA_ALIGN 64 // Byte alignment of every block in a state arena
+#define ROW_PAD_INTS 8 // Matrix rows padded to a multiple of this many ints (one AVX2 vector)
+#define NARROW_PAD_SHORTS 16 // 16-bit rows padded to a multiple of this many shorts
+#define SAFETY_MAX_THREADS BANKER_MAX_THREADS // Per-thread share scratch is sized for this many threads
+#define SAFETY_MIN_WORK (1<<16) // Values compared/added below which a phase runs on the calling thread only
+#define SAFETY_PHASE_COUNT 0 // Phases of the threaded safety check (safetyTask.phase)
+#define SAFETY_PHASE_FILL 1
+#define SAFETY_PHASE_SORT 2
+#define SAFETY_PHASE_RELEASE 3
+#define FIXED_MAX_COLS BANKER_WIDTH_KERNEL_MAX // Resource counts 1..this get width kernels generated at compile time (FIXED_WIDTHS lists each)
+#define FIXED_WIDTHS(X) X(1) X(2) X(3) X(4) X(5) X(6) X(7) X(8) X(9) X(10) X(11) X(12) X(13) X(14) X(15) X(16) // Expands X once per generated width
+#define FIXED_UNROLL _Pragma("GCC unroll 16") // Inner loops of width kernels have a constant trip count, fully unrolled
+#if BANKER_STATS
+#define STAT_ADD(state,counter,amount) ((state)->counters.counter += (amount)) // Counter update, amount not evaluated when compiled out
+#else
+#define STAT_ADD(state,counter,amount) ((void)sizeof(amount)) // Keeps operands referenced (no unused warnings), never evaluated
+#endif
+
+typedef struct rowKernels { // Row kernels used by safety checks, selected once per process (scalar, SSE2 or AVX2). All give identical results
+    const char *name;
+    int (*fits)(const int*,const int*,int); // 1 if every need <= available. Params: needRow,available,cols
+    int (*countExceeds)(const int*,const int*,int*,int); // Counts need > available, adds 1 per such col to colCounts. Params: needRow,available,colCounts,cols. Returns count
+    void (*add)(int*,const int*,int); // available += row. Params: available,row,cols
+    int (*subtract)(int*,const int*,const int*,int); // result = first - second. Params: resultRow,firstRow,secondRow,cols. Returns 1 if any result negative
+    int (*fits16)(const short*,const short*,int); // 16-bit lane fits. Params: needRow,available,cols
+    void (*add16)(short*,const short*,int); // 16-bit lane add. Params: available,row,cols
+} rowKernels;
+
+typedef struct widthKernels { // Kernels generated for one compile-time resource count (DEFINE_WIDTH_KERNELS), vectors held in locals across rows so they stay in registers
+    void (*countRows)(int *const*,const int*,int*,int*,int,int); // Count phase of a row share. Params: needRows,available,colCounts(added to),pendingRes(output),firstRow,lastRow
+    void (*fillRows)(int *const*,const int*,const int*,long long*,int*,int,int); // Fill phase of a row share, packed (need,process) keys. Params: needRows,available,pendingRes,thresholds,cursors(updated),firstRow,lastRow
+    int (*walkPrefix)(int *const*,int *const*,const int*,int,const int*); // Request re-check, fits then adds each process of an order prefix. Params: needRows,allocRows,order,count,available. Returns processes that fit before the first that did not (count if all)
+    void (*add)(int*,const int*); // available += row. Params: available,row
+    int (*subtract)(int*,const int*,const int*); // result = first - second. Params: resultRow,firstRow,secondRow. Returns 1 if any result negative
+} widthKernels;
+
+typedef struct safetyTask { // One worker's share of a threaded safety check phase (rows for count/fill, columns for release, columns claimed from shared counter for sort)
+    int phase; // SAFETY_PHASE_*
+    int first; // First row/column of share
+    int last; // One past last row/column of share
+    int **need;
+    int **alloc;
+    int *available; // Columns [first,last) written by release (each column owned by one task)
+    int colCount;
+    int *pendingRes; // Unsatisfied count per process (atomic decrements in release)
+    int *colCounts; // Count: per-column unsatisfied counts for share. Fill: per-column write cursors for share
+    long long *thresholds;
+    int *resStart;
+    int *resCursor;
+    int *nextColumn; // Sort: shared column counter
+    int *round; // Release: processes completing this round
+    int roundSize;
+    int *woken; // Release: processes becoming ready, appended via wokenCount
+    int *wokenCount;
+    const widthKernels *width; // Count/fill kernels for colCount, NULL for the generic loops
+} safetyTask;
+
+typedef struct whatIfTask { // One thread's share of the what-if candidates the baseline sequence could not prove safe, with its re-check buffers
+    const bankerState *state; // Evaluated state, only read (shared by every task)
+    int *work; // Work vector (cols) | waiting heap roots (cols, -1 if empty) | finished stack (rows) | heap links: left, right, rank (rows each)
+    long long *waitKeys; // Per process, packed (need of the resource it waits on,process) key. A process waits on one resource at a time, so rows nodes hold every heap
+    const int *procs;
+    const int *requests;
+    int requestStride;
+    const int *pending; // Candidate indices left for the guided re-check
+    int pendingCount;
+    int first; // Share is pending[first], pending[first+step], ...
+    int step;
+    int *results;
+} whatIfTask;
+
+typedef struct headroomTask { // One thread's share of the resources of a headroom query, with its closure sweep buffers
+    const bankerState *state; // Queried state, only read (shared by every task)
+    const long long *sortedNeeds; // Per resource, packed (need,process) keys of needs above available, ascending from needStart
+    const int *needStart; // cols+1 offsets into sortedNeeds
+    const int *unsatisfied; // Per process, resources with need above available
+    const int *allocStart; // cols+1 offsets of each resource's breakpoints (one per non-zero allocated value, sparse only)
+    int *buffer; // Unsatisfied, level, order position (rows each) | next, fill, held (cols each) | closure order, covering, column prefix (3*rows+1, dense) or breakpoints (2*allocs, sparse)
+    long long *ready; // Min-heap of processes fitting every other resource, packed (need of swept resource,process) keys
+    int *headroom; // Output, rows*cols
+    int first; // Share is resources first, first+step, ...
+    int step;
+} headroomTask;
+
+struct bankerState { // Header at start of arena, every ptr below points into the same allocation
+    int rowCapacity;
+    int colCapacity;
+    int rowStride; // Ints per matrix row (colCapacity padded)
+    int narrowStride; // Shorts per 16-bit row
+    int flags; // BANKER_* flags given to bankerCreate
+    int threads; // Threads for checks (bankerSetThreads)
+    int rowCount; // Loaded processes
+    int colCount; // Loaded resources
+    int orderIsSafe; // 1 if order is a full safe sequence of current state
+    int queued; // Entries in order
+    unsigned int orderVersion; // Bumped whenever order is rewritten or appended to
+    int narrowActive; // 1 if 16-bit copies are in sync and used
+    int isSparse; // 1 if alloc/need are kept as entries (bankerCreateSparse), row ptrs below are NULL
+    int entryCapacity; // Sparse: max entries (non-zero maximum values)
+    int entryCount; // Sparse: entries in use (rowStart[rowCount])
+    int loadedAllocRows; // Rows given to bankerLoadAllocRow/bankerLoadMaxRow since bankerBeginLoad
+    int loadedMaxRows;
+    int stagedCount; // Sparse load: allocated values staged in thresholds, merged by bankerLoadMaxRow
+    int stagedRead;
+    int loadInvalid; // Sparse load: negative or allocated above maximum seen, reported by bankerEndLoad
+    int **allocRows; // Row ptrs into matrices
+    int **maxRows;
+    int **needRows;
+    int **viewAllocRows; // Row ptrs into matrices owned elsewhere (bankerCheckView)
+    int **viewNeedRows;
+    short *need16; // 16-bit copies, row i at i*narrowStride (NULL without BANKER_NARROW)
+    short *alloc16;
+    short *work16;
+    int *available;
+    int *totalRes; // Available + all allocated, only changes when processes are added
+    int *work; // Available once every queued process of last check finished
+    int *probe; // Work vector for request re-checks
+    int *order; // Sequence of last check
+    int *candOrder; // Sequence of a full re-check during a request, swapped with order if safe
+    int *orderPos; // Position of each process in order (valid while orderIsSafe)
+    int *pendingRes; // Worklist scratch: unsatisfied resource count per process
+    int *readyQueue; // Worklist scratch: ready processes (FIFO, or min-heap with BANKER_LOWEST_FIRST)
+    int *bounds; // Worklist scratch: per-resource [start offsets (cols+1) | cursors (cols)]
+    int *shareCounts; // Worklist scratch: per-thread-share column counts
+    long long *thresholds; // Worklist scratch: packed (need,process) keys, up to rows*cols (entries if sparse)
+    int *priorityKeys; // Ready key per process (bankerSetPriorities), NULL without BANKER_PRIORITY
+    long long *readyKeys; // Worklist scratch: min-heap of packed (key,process), NULL without BANKER_PRIORITY
+    int *rowStart; // Sparse: entries of process i are rowStart[i]..rowStart[i+1]-1, ascending resource
+    int *entryCol; // Sparse: resource of each entry
+    int *entryAlloc;
+    int *entryNeed;
+#if BANKER_STATS
+    bankerCounters counters; // Zeroed by createState, not copied by bankerCopy
+#endif
+};
+
+static int rowFitsScalar(const int*,const int*,int); // Row kernels (see rowKernels struct for params), one set per instruction set
+static int rowCountExceedsScalar(const int*,const int*,int*,int);
+static void rowAddScalar(int*,const int*,int);
+static int rowSubtractScalar(int*,const int*,const int*,int);
+static int rowFits16Scalar(const short*,const short*,int);
+static void rowAdd16Scalar(short*,const short*,int);
+#if HAVE_X86_KERNELS
+static int rowFitsSse2(const int*,const int*,int);
+static int rowCountExceedsSse2(const int*,const int*,int*,int);
+static void rowAddSse2(int*,const int*,int);
+static int rowSubtractSse2(int*,const int*,const int*,int);
+static int rowFits16Sse2(const short*,const short*,int);
+static void rowAdd16Sse2(short*,const short*,int);
+static int rowFitsAvx2(const int*,const int*,int);
+static int rowCountExceedsAvx2(const int*,const int*,int*,int);
+static void rowAddAvx2(int*,const int*,int);
+static int rowSubtractAvx2(int*,const int*,const int*,int);
+static int rowFits16Avx2(const short*,const short*,int);
+static void rowAdd16Avx2(short*,const short*,int);
+#endif
+static int selectRowKernels(const char*); // Sets ROW_KERNELS by name ('auto' picks best supported by cpu). Takes: name. Returns 0 if success, 1 if unknown/unsupported
+static void narrowRow(short*,const int*,int); // Copies int row into 16-bit row (values must fit). Params: shortRow,intRow,cols
+static void *arenaTake(char*,size_t*,size_t); // Next aligned block of arena. Params: arenaBase(NULL if only measuring),offset(updated),bytes. Returns block (NULL if measuring)
+static bankerState *createState(int,int,int,int,int); // Shared by bankerCreate/bankerCreateSparse. Params: rowCapacity,colCapacity,entryCapacity,flags,isSparse. Returns state (NULL if alloc failed or size invalid)
+static size_t bankerLayout(bankerState*,char*); // Points every array of state into arena (capacities already set). Params: state,arenaBase(NULL if only measuring). Returns arena bytes
+static void syncNarrowRow(bankerState*,int); // Refreshes 16-bit copies of one process (if in use). Params: state,process
+static int findSafeSequence(bankerState*,int**,int**,int*,int,int,int*); // Worklist safety check on state scratch. Params: state,needsAllocation,isAllocated,availableCopy(updated),rows,cols,outputOrder. Returns processes queued (rows if safe)
+static int findSafeSequenceSparse(bankerState*,int*,int*); // Same worklist check over entries of a sparse state (calling thread only). Params: state,availableCopy(updated),outputOrder. Returns processes queued
+static int checkLoaded(bankerState*,int*,int*); // Safety check of loaded state (dense or sparse). Params: state,availableCopy(updated),outputOrder. Returns processes queued
+static int entryFits(const bankerState*,int,const int*); // 1 if every need entry of process <= available. Params: state,process,available
+static void entryAdd(const bankerState*,int,int*); // available += allocated entries of process. Params: state,process,available
+static int procValue(const bankerState*,int,int,int); // Need or allocated value of one process and resource (dense or sparse). Params: state,process,resource,isAllocated. Returns value
+static void moveAllocation(bankerState*,int,const int*,int); // Grants (direction 1) or returns (-1) amounts: available -=, allocated +=, need -= direction*amount. Params: state,process,amounts(cols),direction
+static void *whatIfWorker(void*); // Re-checks one share of what-if candidates with guidedCheck (pthread start routine). Takes: whatIfTask. Returns NULL
+static int guidedCheck(whatIfTask*,int,const int*); // Safety of evaluated state with request granted: walks baseline sequence, processes that no longer fit wait until their resource grows. Params: task,process,request. Returns 1 if safe, 0 if unsafe
+static int blockingResource(const bankerState*,int,int,const int*,const int*,int*); // First resource where need (less request, for requesting process) exceeds work. Params: state,process,requestingProcess,request,work,outputNeed. Returns resource, -1 if process fits
+static void foldSlack(const bankerState*,int,int*,int*,int); // Lowers prefix slack to work - need of process, then adds its allocation to work. Params: state,process,work,slack,isFirst(slack starts at work)
+static void guidedHeadroom(whatIfTask*,int,int*,int*); // Headroom row of one process: doubling steps above its proven bound until unsafe, then bisection, with guidedCheck. Params: task,process,outputHeadroom(cols),scratch(request | work | slack, cols each)
+static void *headroomWorker(void*); // Runs headroomSweep for one share of resources (pthread start routine). Takes: headroomTask. Returns NULL
+static void headroomSweep(headroomTask*,int); // Maximum safe grant of one resource for every process, from one closure sweep with that resource lowered. Params: task,resource
+static void denseCovering(headroomTask*,int,int); // Shortest closure prefix of last sweep covering need of each process (0 if need fits available, closureSize+1 if never covered), one resource column at a time. Params: task,sweptResource,closureSize
+static int prefixCovered(const int*,int,int,int); // First closure size from low on whose prefix sum reaches amount. Params: prefix(closureSize+1),low,closureSize,amount. Returns closure size, closureSize+1 if never reached
+static int sparseCovering(headroomTask*,int); // Same from per-resource breakpoints of a sparse state. Params: task,process. Returns prefix length (rows+1 if never covered)
+static int coveredAt(const int*,const int*,int,int,int,int); // First closure size whose allocated sum reaches amount. Params: joinedAt,allocSum,first,last,amount,rows. Returns closure size, rows+1 if never reached
+static void waitPush(whatIfTask*,int,long long); // Pushes key onto waiting heap of resource (its process becomes the node). Params: task,resource,key
+static long long waitPop(whatIfTask*,int); // Pops smallest key of waiting heap. Params: task,resource. Returns key
+static int waitMerge(whatIfTask*,int,int); // Merges two leftist waiting heaps, recursion only follows right spines (O(log rows) deep). Params: task,rootA,rootB(-1 if empty). Returns merged root
+static void guidedLayout(const bankerState*,char*,size_t*,whatIfTask*); // Carves guidedCheck buffers of one task from a workspace (capacity sized). Params: state,workspaceBase(NULL if only measuring),offset(updated),task
+static size_t whatIfLayout(const bankerState*,int,char*,whatIfTask*,long long**,int**); // Carves bankerWhatIf workspace, same order every time (see bankerLayout). Params: state,count,workspaceBase(NULL if only measuring),outputTasks(one per thread),outputKeys(count+1),outputInts(codes, pending (count+1 each) | work, slack (cols each)). Returns workspace bytes
+static size_t headroomLayout(const bankerState*,int,char*,headroomTask*,whatIfTask*,int**,long long**); // Carves bankerHeadroom workspace. Params: state,process(-1 for all),workspaceBase(NULL if only measuring),outputTasks(all: one per thread),outputGuided(one process),outputInts(all: needStart, allocStart (cols+1 each) | unsatisfied (rows) | fill (cols+1), one process: request | work | slack (cols each)),outputSortedNeeds(all). Returns workspace bytes
+static void *safetyWorker(void*); // Runs one safetyTask (pthread start routine). Takes: task. Returns NULL
+static const widthKernels *widthKernelsFor(const bankerState*,int); // Generated kernels for resource count, unless state has BANKER_GENERIC_WIDTH. Params: state,cols. Returns kernels, NULL if none
+static void runSafetyTasks(safetyTask*,int); // Runs tasks on worker threads (first on calling thread), waits for all. Params: tasks,taskCount
+static long long countWakes(const int*,const int*,int); // Thresholds passed by the drain of last check. Params: resStart,resCursor,cols. Returns sum of cursor - start
+static int compareInts(const void*,const void*); // qsort comparator for ascending ints
+static int compareThresholds(const void*,const void*); // qsort comparator for packed (need,process) long long keys
+static void heapPushMin(int*,int*,int); // Pushes value onto int min-heap. Params: heap,heapSize(updated),value
+static int heapPopMin(int*,int*); // Pops smallest value from int min-heap. Params: heap,heapSize(updated). Returns popped value
+static void keyPushMin(long long*,int*,long long); // Pushes packed key onto long long min-heap. Params: heap,heapSize(updated),key
+static long long keyPopMin(long long*,int*); // Pops smallest packed key. Params: heap,heapSize(updated). Returns popped key
+static long long readyKey(const bankerState*,int); // Packed (priority key,process), any int key orders correctly. Params: state,process. Returns key
+
+static rowKernels ROW_KERNELS = {"scalar",rowFitsScalar,rowCountExceedsScalar,rowAddScalar,rowSubtractScalar,rowFits16Scalar,rowAdd16Scalar}; // Active row kernels
+static int KERNELS_CHOSEN = 0; // 1 once bankerSelectKernels ran (bankerCreate picks 'auto' otherwise)
+
+
+
+//// State lifetime
+bankerState *bankerCreate(int rowCapacity, int colCapacity, int flags) {
+    return createState(rowCapacity,colCapacity,0,flags,0);
+}
+bankerState *bankerCreateSparse(int rowCapacity, int colCapacity, int entryCapacity, int flags) {
+    return createState(rowCapacity,colCapacity,entryCapacity,flags,1);
+}
+static bankerState *createState(int rowCapacity, int colCapacity, int entryCapacity, int flags, int isSparse) { // Everything a state will ever use is allocated here, once
+    if (rowCapacity <= 0 || colCapacity <= 0 || entryCapacity < 0) { return NULL; }
+    if (!KERNELS_CHOSEN) { bankerSelectKernels("auto"); }
+    bankerState sizing;
+    memset(&sizing,0,sizeof(sizing));
+    sizing.rowCapacity = rowCapacity;
+    sizing.colCapacity = colCapacity;
+    sizing.rowStride = (colCapacity + ROW_PAD_INTS - 1) / ROW_PAD_INTS * ROW_PAD_INTS;
+    sizing.narrowStride = (colCapacity + NARROW_PAD_SHORTS - 1) / NARROW_PAD_SHORTS * NARROW_PAD_SHORTS;
+    sizing.flags = flags;
+    sizing.threads = 1;
+    sizing.isSparse = isSparse;
+    sizing.entryCapacity = entryCapacity;
+    size_t arenaBytes = bankerLayout(&sizing,NULL);
+    void *arena = NULL;
+    if (posix_memalign(&arena,ARENA_ALIGN,arenaBytes) != 0) { return NULL; }
+
+    bankerState *state = (bankerState*)arena;
+    *state = sizing;
+    bankerLayout(state,(char*)arena);
+    if (state->priorityKeys != NULL) { memset(state->priorityKeys,0,sizeof(int)*(size_t)rowCapacity); } // Equal keys until set, lowest index first
+    if (isSparse || (flags & BANKER_VIEW_ONLY)) { return state; } // Entries filled by loads (or no matrices at all), nothing to split into rows
+    int *matrices = state->allocRows[0]; // First row ptr temporarily holds block start (see bankerLayout). Rows not zeroed, loads fill every value used and kernels never read padding
+    for (int i = 0; i < rowCapacity; ++i) {
+        state->allocRows[i] = matrices + (size_t)i*state->rowStride;
+        state->maxRows[i] = matrices + ((size_t)rowCapacity + i)*state->rowStride;
+        state->needRows[i] = matrices + ((size_t)2*rowCapacity + i)*state->rowStride;
+    }
+    return state;
+}
+void bankerDestroy(bankerState *state) {
+    free(state); // Arena starts with state, free(NULL) does nothing
+}
+bankerState *bankerClone(const bankerState *source) {
+    bankerState *clone = createState(source->rowCapacity,source->colCapacity,source->entryCapacity,source->flags,source->isSparse);
+    if (clone == NULL) { return NULL; }
+    clone->threads = source->threads;
+    bankerCopy(clone,source);
+    return clone;
+}
+int bankerCopy(bankerState *target, const bankerState *source) { // Only live rows/cols copied (scratch is rebuilt by every check)
+    if (source->rowCount > target->rowCapacity || source->colCount > target->colCapacity || source->isSparse != target->isSparse) { return BANKER_INVALID; }
+    if (source->isSparse && source->entryCount > target->entryCapacity) { return BANKER_INVALID; }
+    if (!target->isSparse && target->allocRows == NULL && source->rowCount > 0) { return BANKER_INVALID; } // BANKER_VIEW_ONLY target holds no rows
+    int rows = source->rowCount;
+    size_t rowBytes = sizeof(int)*(size_t)source->colCount;
+    if (source->isSparse) {
+        size_t entryBytes = sizeof(int)*(size_t)source->entryCount;
+        memcpy(target->rowStart,source->rowStart,sizeof(int)*((size_t)rows+1));
+        memcpy(target->entryCol,source->entryCol,entryBytes);
+        memcpy(target->entryAlloc,source->entryAlloc,entryBytes);
+        memcpy(target->entryNeed,source->entryNeed,entryBytes);
+        target->entryCount = source->entryCount;
+    }
+    for (int i = 0; i < rows && !source->isSparse; ++i) {
+        memcpy(target->allocRows[i],source->allocRows[i],rowBytes);
+        memcpy(target->maxRows[i],source->maxRows[i],rowBytes);
+        memcpy(target->needRows[i],source->needRows[i],rowBytes);
+    }
+    memcpy(target->available,source->available,rowBytes);
+    memcpy(target->totalRes,source->totalRes,rowBytes);
+    memcpy(target->work,source->work,rowBytes);
+    memcpy(target->order,source->order,sizeof(int)*(size_t)source->queued);
+    if (source->orderIsSafe) { memcpy(target->orderPos,source->orderPos,sizeof(int)*(size_t)rows); }
+    if (source->priorityKeys != NULL && target->priorityKeys != NULL) { memcpy(target->priorityKeys,source->priorityKeys,sizeof(int)*(size_t)rows); }
+    target->rowCount = rows;
+    target->colCount = source->colCount;
+    target->orderIsSafe = source->orderIsSafe;
+    target->queued = source->queued;
+    target->orderVersion = source->orderVersion + 1; // Never equal to a version the target had before
+    target->narrowActive = source->narrowActive && target->need16 != NULL; // Target without 16-bit storage uses 32-bit re-checks
+    for (int i = 0; i < rows && target->narrowActive; ++i) { syncNarrowRow(target,i); }
+    return BANKER_OK;
+}
+int bankerSetThreads(bankerState *state, int threads) {
+    if (threads < 1 || threads > SAFETY_MAX_THREADS) { return BANKER_INVALID; }
+    state->threads = threads;
+    return BANKER_OK;
+}
+int bankerSelectKernels(const char *name) {
+    KERNELS_CHOSEN = 1;
+    return selectRowKernels(name);
+}
+const char *bankerKernelName(void) {
+    return ROW_KERNELS.name;
+}
+static void *arenaTake(char *base, size_t *offset, size_t bytes) { // Every block starts on a cache line, so rows of one block never share a line with another block
+    size_t start = (*offset + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+    *offset = start + bytes;
+    return (base == NULL) ? NULL : (void*)(base + start);
+}
+static size_t bankerLayout(bankerState *state, char *base) { // Same order every time, so measuring and carving agree
+    size_t rows = (size_t)state->rowCapacity;
+    size_t cols = (size_t)state->colCapacity;
+    size_t offset = 0;
+    size_t entries = (size_t)state->entryCapacity;
+    arenaTake(base,&offset,sizeof(bankerState));
+    state->allocRows = NULL;
+    state->maxRows = NULL;
+    state->needRows = NULL;
+    state->viewAllocRows = NULL;
+    state->viewNeedRows = NULL;
+    state->rowStart = NULL;
+    state->entryCol = NULL;
+    state->entryAlloc = NULL;
+    state->entryNeed = NULL;
+    if (state->isSparse) { // Only non-zero maximum values stored, need/alloc kept side by side per entry
+        state->rowStart = (int*)arenaTake(base,&offset,sizeof(int)*(rows+1));
+        state->entryCol = (int*)arenaTake(base,&offset,sizeof(int)*entries);
+        state->entryAlloc = (int*)arenaTake(base,&offset,sizeof(int)*entries);
+        state->entryNeed = (int*)arenaTake(base,&offset,sizeof(int)*entries);
+    } else {
+        int ownsRows = !(state->flags & BANKER_VIEW_ONLY); // View-only states only check matrices owned elsewhere
+        if (ownsRows) {
+            state->allocRows = (int**)arenaTake(base,&offset,sizeof(int*)*rows);
+            state->maxRows = (int**)arenaTake(base,&offset,sizeof(int*)*rows);
+            state->needRows = (int**)arenaTake(base,&offset,sizeof(int*)*rows);
+        }
+        state->viewAllocRows = (int**)arenaTake(base,&offset,sizeof(int*)*rows);
+        state->viewNeedRows = (int**)arenaTake(base,&offset,sizeof(int*)*rows);
+        if (ownsRows) {
+            int *matrices = (int*)arenaTake(base,&offset,sizeof(int)*3*rows*(size_t)state->rowStride); // alloc | max | need, split into rows by bankerCreate
+            if (base != NULL) { state->allocRows[0] = matrices; }
+        }
+    }
+    state->need16 = NULL;
+    state->alloc16 = NULL;
+    state->work16 = NULL;
+    if ((state->flags & BANKER_NARROW) && !state->isSparse && !(state->flags & BANKER_VIEW_ONLY)) {
+        state->need16 = (short*)arenaTake(base,&offset,sizeof(short)*rows*(size_t)state->narrowStride);
+        state->alloc16 = (short*)arenaTake(base,&offset,sizeof(short)*rows*(size_t)state->narrowStride);
+        state->work16 = (short*)arenaTake(base,&offset,sizeof(short)*(size_t)state->narrowStride);
+    }
+    state->available = (int*)arenaTake(base,&offset,sizeof(int)*cols);
+    state->totalRes = (int*)arenaTake(base,&offset,sizeof(int)*cols);
+    state->work = (int*)arenaTake(base,&offset,sizeof(int)*cols);
+    state->probe = (int*)arenaTake(base,&offset,sizeof(int)*cols);
+    state->order = (int*)arenaTake(base,&offset,sizeof(int)*rows);
+    state->candOrder = (int*)arenaTake(base,&offset,sizeof(int)*rows);
+    state->orderPos = (int*)arenaTake(base,&offset,sizeof(int)*rows);
+    state->pendingRes = (int*)arenaTake(base,&offset,sizeof(int)*rows);
+    state->readyQueue = (int*)arenaTake(base,&offset,sizeof(int)*rows);
+    state->bounds = (int*)arenaTake(base,&offset,sizeof(int)*(2*cols+1));
+    state->shareCounts = (int*)arenaTake(base,&offset,sizeof(int)*SAFETY_MAX_THREADS*cols);
+    state->thresholds = (long long*)arenaTake(base,&offset,sizeof(long long)*(state->isSparse ? entries : rows*cols)); // Worst case every (process,resource) pair unsatisfied (every entry if sparse)
+    state->priorityKeys = NULL;
+    state->readyKeys = NULL;
+    if (state->flags & BANKER_PRIORITY) {
+        state->priorityKeys = (int*)arenaTake(base,&offset,sizeof(int)*rows);
+        state->readyKeys = (long long*)arenaTake(base,&offset,sizeof(long long)*rows);
+    }
+    return offset;
+}
+
+
+
+//// Loading
+int bankerLoad(bankerState *state, int rowCount, int colCount, const int *allocated, const int *maximum, const int *available, int rowStride) {
+    if (bankerBeginLoad(state,rowCount,colCount) != BANKER_OK || rowStride < colCount) { return BANKER_INVALID; }
+    size_t rowBytes = sizeof(int)*(size_t)colCount;
+    if (state->isSparse) { // Rows go through the entry loaders
+        int result = BANKER_OK;
+        for (int i = 0; i < rowCount && result == BANKER_OK; ++i) { result = bankerLoadAllocRow(state,i,allocated + (size_t)i*rowStride); }
+        for (int i = 0; i < rowCount && result == BANKER_OK; ++i) { result = bankerLoadMaxRow(state,i,maximum + (size_t)i*rowStride); }
+        if (result != BANKER_OK) { return result; }
+        memcpy(state->available,available,rowBytes);
+        return bankerEndLoad(state);
+    }
+    for (int i = 0; i < rowCount; ++i) {
+        memcpy(state->allocRows[i],allocated + (size_t)i*rowStride,rowBytes);
+        memcpy(state->maxRows[i],maximum + (size_t)i*rowStride,rowBytes);
+    }
+    memcpy(state->available,available,rowBytes);
+    return bankerEndLoad(state);
+}
+int bankerBeginLoad(bankerState *state, int rowCount, int colCount) {
+    if (rowCount <= 0 || colCount <= 0 || rowCount > state->rowCapacity || colCount > state->colCapacity) { return BANKER_INVALID; }
+    if ((state->flags & BANKER_VIEW_ONLY) && !state->isSparse) { return BANKER_INVALID; } // Nowhere to load into
+    state->rowCount = rowCount;
+    state->colCount = colCount;
+    state->orderIsSafe = 0;
+    state->queued = 0;
+    ++state->orderVersion;
+    state->narrowActive = 0;
+    state->loadedAllocRows = 0;
+    state->loadedMaxRows = 0;
+    state->stagedCount = 0;
+    state->stagedRead = 0;
+    state->loadInvalid = 0;
+    state->entryCount = 0;
+    if (state->isSparse) { state->rowStart[0] = 0; }
+    return BANKER_OK;
+}
+int bankerLoadAllocRow(bankerState *state, int proc, const int *row) { // Sparse: non-zero values staged in thresholds (scratch is free until the first check), per-row counts in pendingRes
+    int cols = state->colCount;
+    if (proc != state->loadedAllocRows || proc >= state->rowCount) { return BANKER_INVALID; }
+    if (!state->isSparse) {
+        memcpy(state->allocRows[proc],row,sizeof(int)*(size_t)cols);
+        ++state->loadedAllocRows;
+        return BANKER_OK;
+    }
+    int staged = state->stagedCount;
+    for (int j = 0; j < cols; ++j) {
+        if (row[j] == 0) { continue; }
+        if (staged == state->entryCapacity) { return BANKER_FULL; }
+        state->loadInvalid |= (row[j] < 0);
+        state->thresholds[staged++] = ((long long)j << 32) | (unsigned int)row[j]; // Packed (resource,value), read back in order
+    }
+    state->pendingRes[proc] = staged - state->stagedCount;
+    state->stagedCount = staged;
+    ++state->loadedAllocRows;
+    return BANKER_OK;
+}
+int bankerLoadMaxRow(bankerState *state, int proc, const int *row) { // Sparse: merges staged allocated values of process with maximum row into entries (one per non-zero maximum)
+    int cols = state->colCount;
+    if (proc != state->loadedMaxRows || state->loadedAllocRows != state->rowCount) { return BANKER_INVALID; }
+    if (!state->isSparse) {
+        memcpy(state->maxRows[proc],row,sizeof(int)*(size_t)cols);
+        ++state->loadedMaxRows;
+        return BANKER_OK;
+    }
+    int staged = state->stagedRead;
+    int stagedEnd = staged + state->pendingRes[proc];
+    int entry = state->entryCount;
+    for (int j = 0; j < cols; ++j) {
+        int allocated = 0;
+        if (staged < stagedEnd && (int)(state->thresholds[staged] >> 32) == j) { allocated = (int)(state->thresholds[staged++] & 0xFFFFFFFF); }
+        if (row[j] == 0 && allocated == 0) { continue; } // Zero need and zero allocation, nothing stored
+        if (entry == state->entryCapacity) { return BANKER_FULL; }
+        state->loadInvalid |= (row[j] < allocated); // Allocated above maximum (also catches a negative maximum)
+        state->entryCol[entry] = j;
+        state->entryAlloc[entry] = allocated;
+        state->entryNeed[entry] = row[j] - allocated;
+        ++entry;
+    }
+    state->rowStart[proc+1] = entry;
+    state->entryCount = entry;
+    state->stagedRead = stagedEnd;
+    ++state->loadedMaxRows;
+    return BANKER_OK;
+}
+int bankerEndLoad(bankerState *state) { // need = max - alloc, totals, 16-bit copies. Invalid states are left loaded but must not be checked
+    int rows = state->rowCount;
+    int cols = state->colCount;
+    int invalid = 0;
+    int signs = 0; // OR of allocated and available values, negative if any is
+    memcpy(state->totalRes,state->available,sizeof(int)*(size_t)cols);
+    for (int j = 0; j < cols; ++j) { signs |= state->available[j]; }
+    if (state->isSparse) { // Need already computed by bankerLoadMaxRow
+        if (state->loadedMaxRows != rows || state->loadInvalid || signs < 0) { return BANKER_INVALID; }
+        for (int e = 0; e < state->entryCount; ++e) { state->totalRes[state->entryCol[e]] += state->entryAlloc[e]; }
+        return BANKER_OK;
+    }
+    const widthKernels *width = widthKernelsFor(state,cols);
+    for (int i = 0; i < rows; ++i) {
+        if (width != NULL) { invalid |= width->subtract(state->needRows[i],state->maxRows[i],state->allocRows[i]); }
+        else { invalid |= ROW_KERNELS.subtract(state->needRows[i],state->maxRows[i],state->allocRows[i],cols); } // Allocated above maximum
+        for (int j = 0; j < cols; ++j) { signs |= state->allocRows[i][j]; }
+        if (width != NULL) { width->add(state->totalRes,state->allocRows[i]); }
+        else { ROW_KERNELS.add(state->totalRes,state->allocRows[i],cols); }
+    }
+    if (invalid || signs < 0) { return BANKER_INVALID; }
+
+    // 16-bit copies only exact if every work vector value fits (available never exceeds total) and every need does
+    state->narrowActive = (state->need16 != NULL);
+    for (int j = 0; j < cols && state->narrowActive; ++j) { if (state->totalRes[j] > 0x7FFF) { state->narrowActive = 0; } }
+    for (int i = 0; i < rows && state->narrowActive; ++i) {
+        for (int j = 0; j < cols; ++j) { if (state->maxRows[i][j] > 0x7FFF) { state->narrowActive = 0; break; } }
+    }
+    for (int i = 0; i < rows && state->narrowActive; ++i) { syncNarrowRow(state,i); }
+    return BANKER_OK;
+}
+int bankerSetPriorities(bankerState *state, const int *keys) { // Keys are read by the drain only, so the current sequence stays valid until the next check
+    if (state->priorityKeys == NULL) { return BANKER_INVALID; }
+    for (int i = 0; i < state->rowCount; ++i) {
+        if (keys != NULL) { state->priorityKeys[i] = keys[i]; continue; }
+        long long total = 0; // Remaining need over every resource, as a run length estimate
+        if (state->isSparse) { for (int e = state->rowStart[i]; e < state->rowStart[i+1]; ++e) { total += state->entryNeed[e]; } }
+        else { for (int j = 0; j < state->colCount; ++j) { total += state->needRows[i][j]; } }
+        state->priorityKeys[i] = (total > 0x7FFFFFFF) ? 0x7FFFFFFF : (int)total;
+    }
+    return BANKER_OK;
+}
+int **bankerAllocRows(bankerState *state) { return state->allocRows; }
+int **bankerMaxRows(bankerState *state) { return state->maxRows; }
+int **bankerNeedRows(bankerState *state) { return state->needRows; }
+int *bankerAvailable(bankerState *state) { return state->available; }
+static void syncNarrowRow(bankerState *state, int proc) {
+    if (!state->narrowActive) { return; }
+    narrowRow(state->need16 + (size_t)proc*state->narrowStride,state->needRows[proc],state->colCount);
+    narrowRow(state->alloc16 + (size_t)proc*state->narrowStride,state->allocRows[proc],state->colCount);
+}
+
+
+
+//// Checks and updates
+int bankerCheck(bankerState *state) {
+    memcpy(state->work,state->available,sizeof(int)*(size_t)state->colCount);
+    state->queued = checkLoaded(state,state->work,state->order);
+    ++state->orderVersion;
+    state->orderIsSafe = (state->queued == state->rowCount);
+    for (int i = 0; i < state->queued && state->orderIsSafe; ++i) { state->orderPos[state->order[i]] = i; } // Position lookup for prefix re-checks
+    return state->queued;
+}
+int bankerCheckView(bankerState *state, int rowCount, int colCount, const int *allocated, const int *needed, const int *available, int rowStride) { // Row ptrs into caller's matrices, values never copied
+    if (rowCount <= 0 || colCount <= 0 || rowCount > state->rowCapacity || colCount > state->colCapacity || rowStride < colCount || state->isSparse) { return BANKER_INVALID; } // Sparse scratch only fits its entries
+    for (int i = 0; i < rowCount; ++i) { // Worklist only reads these rows
+        state->viewAllocRows[i] = (int*)(allocated + (size_t)i*rowStride);
+        state->viewNeedRows[i] = (int*)(needed + (size_t)i*rowStride);
+    }
+    memcpy(state->work,available,sizeof(int)*(size_t)colCount);
+    state->queued = findSafeSequence(state,state->viewNeedRows,state->viewAllocRows,state->work,rowCount,colCount,state->order);
+    state->orderIsSafe = 0; // Sequence belongs to view, not to loaded state
+    ++state->orderVersion;
+    return state->queued;
+}
+int bankerRequest(bankerState *state, int proc, const int *request) { // Standard resource-request algorithm, with prefix-only re-verification
+    int cols = state->colCount;
+    if (proc < 0 || proc >= state->rowCount) { return BANKER_INVALID; }
+    for (int j = 0; j < cols; ++j) { if (request[j] < 0) { return BANKER_INVALID; } }
+    for (int j = 0; j < cols; ++j) { if (request[j] > procValue(state,proc,j,0)) { return BANKER_DENY_MAXIMUM; } } // Request over declared maximum
+    for (int j = 0; j < cols; ++j) { if (request[j] > state->available[j]) { return BANKER_DENY_AVAILABLE; } } // Must wait for resources
+
+    moveAllocation(state,proc,request,1); // Tentatively grant
+
+    // Processes after proc in the old sequence see the same work vector as before (proc returns what it took),
+    //     so only processes queued before proc need to be re-checked against the reduced available vector
+    int safe = 0;
+    const widthKernels *width = widthKernelsFor(state,cols);
+    if (state->orderIsSafe && state->narrowActive) { // Same check on 16-bit copies, twice the values per vector
+        safe = 1;
+        for (int j = 0; j < cols; ++j) { state->work16[j] = (short)state->available[j]; }
+        for (int i = 0; i < state->orderPos[proc] && safe; ++i) {
+            size_t queuedRow = (size_t)state->order[i]*state->narrowStride;
+            safe = ROW_KERNELS.fits16(state->need16 + queuedRow,state->work16,cols);
+            STAT_ADD(state,rowCompares,1);
+            ROW_KERNELS.add16(state->work16,state->alloc16 + queuedRow,cols);
+        }
+    } else if (state->orderIsSafe && state->isSparse) {
+        safe = 1;
+        memcpy(state->probe,state->available,sizeof(int)*(size_t)cols);
+        for (int i = 0; i < state->orderPos[proc] && safe; ++i) {
+            safe = entryFits(state,state->order[i],state->probe);
+            STAT_ADD(state,rowCompares,1);
+            entryAdd(state,state->order[i],state->probe);
+        }
+    } else if (state->orderIsSafe && width != NULL) { // Work vector stays in registers for the whole prefix
+        int prefix = state->orderPos[proc];
+        int passed = width->walkPrefix(state->needRows,state->allocRows,state->order,prefix,state->available);
+        safe = (passed == prefix);
+        STAT_ADD(state,rowCompares,passed + !safe);
+    } else if (state->orderIsSafe) {
+        safe = 1;
+        memcpy(state->probe,state->available,sizeof(int)*(size_t)cols);
+        for (int i = 0; i < state->orderPos[proc] && safe; ++i) {
+            int queuedProc = state->order[i];
+            safe = ROW_KERNELS.fits(state->needRows[queuedProc],state->probe,cols);
+            STAT_ADD(state,rowCompares,1);
+            ROW_KERNELS.add(state->probe,state->allocRows[queuedProc],cols);
+        }
+    }
+    if (!safe && state->orderIsSafe) { STAT_ADD(state,earlyExits,1); } // Prefix re-check stopped at a row that no longer fits
+    if (!safe) { // Old sequence broken (or unknown), search for a new one
+        memcpy(state->probe,state->available,sizeof(int)*(size_t)cols);
+        int queued = checkLoaded(state,state->probe,state->candOrder);
+        if (queued == state->rowCount) { // New safe sequence replaces old one
+            int *tempOrder = state->order;
+            state->order = state->candOrder;
+            state->candOrder = tempOrder;
+            for (int i = 0; i < queued; ++i) { state->orderPos[state->order[i]] = i; }
+            memcpy(state->work,state->probe,sizeof(int)*(size_t)cols);
+            state->orderIsSafe = 1;
+            state->queued = queued;
+            ++state->orderVersion;
+            safe = 1;
+        }
+    }
+    if (safe) { return BANKER_OK; }
+
+    moveAllocation(state,proc,request,-1); // Roll back tentative grant, previous state (and sequence) still valid
+    return BANKER_DENY_UNSAFE;
+}
+int bankerRelease(bankerState *state, int proc, const int *release) { // Returned resources raise available and need equally, any old safe sequence stays safe
+    int cols = state->colCount;
+    if (proc < 0 || proc >= state->rowCount) { return BANKER_INVALID; }
+    for (int j = 0; j < cols; ++j) { if (release[j] < 0) { return BANKER_INVALID; } }
+    for (int j = 0; j < cols; ++j) { if (release[j] > procValue(state,proc,j,1)) { return BANKER_DENY_ALLOCATED; } }
+    moveAllocation(state,proc,release,-1);
+    return BANKER_OK;
+}
+int bankerAddProcess(bankerState *state, const int *maximum) { // New process with zero allocation, safe at end of sequence if max <= total resources
+    int cols = state->colCount;
+    int proc = state->rowCount;
+    for (int j = 0; j < cols; ++j) { if (maximum[j] < 0) { return BANKER_INVALID; } }
+    for (int j = 0; j < cols; ++j) { if (maximum[j] > state->totalRes[j]) { return BANKER_DENY_TOTAL; } }
+    if (proc == state->rowCapacity) { return BANKER_FULL; }
+    if (!state->isSparse && state->allocRows == NULL) { return BANKER_INVALID; } // BANKER_VIEW_ONLY, no rows to append to
+    if (state->isSparse) { // Entries appended after last process
+        int entry = state->entryCount;
+        for (int j = 0; j < cols; ++j) { entry += (maximum[j] != 0); }
+        if (entry > state->entryCapacity) { return BANKER_FULL; }
+        entry = state->entryCount;
+        for (int j = 0; j < cols; ++j) {
+            if (maximum[j] == 0) { continue; }
+            state->entryCol[entry] = j;
+            state->entryAlloc[entry] = 0;
+            state->entryNeed[entry] = maximum[j];
+            ++entry;
+        }
+        state->rowStart[proc+1] = entry;
+        state->entryCount = entry;
+    }
+    for (int j = 0; j < cols && !state->isSparse; ++j) {
+        state->maxRows[proc][j] = maximum[j];
+        state->allocRows[proc][j] = 0;
+        state->needRows[proc][j] = maximum[j];
+    }
+    if (state->priorityKeys != NULL) { state->priorityKeys[proc] = 0; }
+    state->order[proc] = proc; // Appended last, all other processes have released by then
+    state->orderPos[proc] = proc;
+    state->rowCount = proc + 1;
+    if (state->orderIsSafe) {
+        state->queued = state->rowCount;
+        ++state->orderVersion;
+    }
+    syncNarrowRow(state,proc); // max <= total, fits
+    return BANKER_OK;
+}
+int bankerWhatIf(const bankerState *state, int count, const int *procs, const int *requests, int requestStride, unsigned char *grantBits, int *results, int *provenCount, void *workspace, size_t workspaceBytes) { // Baseline sequence swept once in position order, only candidates breaking its prefix slack are re-checked along it
+    int rows = state->rowCount;
+    int cols = state->colCount;
+    if (count < 0 || requestStride < cols || workspace == NULL || workspaceBytes < bankerWhatIfWorkspace(state,count)) { return BANKER_INVALID; }
+    whatIfTask tasks[SAFETY_MAX_THREADS];
+    long long *keys; // Packed (sequence position,candidate)
+    int *ints;
+    whatIfLayout(state,count,(char*)workspace,tasks,&keys,&ints);
+    int *codes = (results != NULL) ? results : ints;
+    int *pending = ints + count+1;
+    int *work = pending + count+1;
+
+    // Same up-front checks as bankerRequest, survivors sorted by position of their process in the baseline sequence
+    int keyCount = 0;
+    for (int i = 0; i < count; ++i) {
+        const int *request = requests + (size_t)i*requestStride;
+        int proc = procs[i];
+        codes[i] = BANKER_OK;
+        if (proc < 0 || proc >= rows) { codes[i] = BANKER_INVALID; continue; }
+        for (int j = 0; j < cols && codes[i] == BANKER_OK; ++j) { if (request[j] < 0) { codes[i] = BANKER_INVALID; } }
+        for (int j = 0; j < cols && codes[i] == BANKER_OK; ++j) { if (request[j] > procValue(state,proc,j,0)) { codes[i] = BANKER_DENY_MAXIMUM; } }
+        for (int j = 0; j < cols && codes[i] == BANKER_OK; ++j) { if (request[j] > state->available[j]) { codes[i] = BANKER_DENY_AVAILABLE; } }
+        if (codes[i] != BANKER_OK) { continue; }
+        if (!state->orderIsSafe) { codes[i] = BANKER_DENY_UNSAFE; continue; } // A grant only shrinks work vectors, so it never makes an unsafe state safe
+        keys[keyCount++] = ((long long)state->orderPos[proc] << 32) | i;
+    }
+    qsort(keys,(size_t)keyCount,sizeof(long long),compareThresholds);
+
+    // A request r by the process at position p keeps the baseline sequence safe if r <= work - need of every process before p
+    //     (p itself needs r less, and everything after p sees the old work vector), so slack = min of those over the prefix
+    int *slack = work + cols;
+    int swept = 0; // Sequence positions folded into slack
+    int pendingCount = 0;
+    int proven = 0;
+    memcpy(work,state->available,sizeof(int)*(size_t)cols);
+    for (int k = 0; k < keyCount; ++k) {
+        int pos = (int)(keys[k] >> 32);
+        int i = (int)(keys[k] & 0xFFFFFFFF);
+        for (; swept < pos; ++swept) { foldSlack(state,state->order[swept],work,slack,swept == 0); }
+        const int *request = requests + (size_t)i*requestStride;
+        int fits = 1;
+        for (int j = 0; j < cols && fits && pos > 0; ++j) { fits = (request[j] <= slack[j]); }
+        if (fits) { ++proven; }
+        else { pending[pendingCount++] = i; }
+    }
+
+    // Unproven candidates are re-checked along the baseline sequence (state only read, so threads share it), see guidedCheck
+    int taskCount = (state->threads < pendingCount) ? state->threads : pendingCount;
+    for (int t = 0; t < taskCount; ++t) {
+        tasks[t].state = state;
+        tasks[t].procs = procs;
+        tasks[t].requests = requests;
+        tasks[t].requestStride = requestStride;
+        tasks[t].pending = pending;
+        tasks[t].pendingCount = pendingCount;
+        tasks[t].first = t;
+        tasks[t].step = taskCount; // Interleaved, so shares of sequence-ordered candidates cost about the same
+        tasks[t].results = codes;
+    }
+    pthread_t threads[SAFETY_MAX_THREADS];
+    int started[SAFETY_MAX_THREADS] = {0};
+    for (int t = 1; t < taskCount; ++t) { started[t] = (pthread_create(&threads[t],NULL,whatIfWorker,&tasks[t]) == 0); }
+    if (taskCount > 0) { whatIfWorker(&tasks[0]); }
+    for (int t = 1; t < taskCount; ++t) {
+        if (started[t]) { pthread_join(threads[t],NULL); }
+        else { whatIfWorker(&tasks[t]); }
+    }
+
+    int granted = 0;
+    if (grantBits != NULL) { memset(grantBits,0,((size_t)count+7)/8); }
+    for (int i = 0; i < count; ++i) {
+        if (codes[i] != BANKER_OK) { continue; }
+        ++granted;
+        if (grantBits != NULL) { grantBits[i >> 3] |= (unsigned char)(1 << (i & 7)); }
+    }
+    if (provenCount != NULL) { *provenCount = proven; }
+    return granted;
+}
+size_t bankerWhatIfWorkspace(const bankerState *state, int count) {
+    return whatIfLayout(state,(count > 0) ? count : 0,NULL,NULL,NULL,NULL);
+}
+int bankerHeadroom(const bankerState *state, int proc, int *headroom, void *workspace, size_t workspaceBytes) { // Closure of a lowered available vector does not depend on who holds the difference, so for all processes one sweep per resource answers every row
+    int rows = state->rowCount;
+    int cols = state->colCount;
+    if (proc < -1 || proc >= rows || headroom == NULL || workspace == NULL || workspaceBytes < bankerHeadroomWorkspace(state,proc)) { return BANKER_INVALID; }
+    memset(headroom,0,sizeof(int)*(size_t)((proc < 0) ? rows : 1)*cols);
+    if (!state->orderIsSafe) { return BANKER_DENY_UNSAFE; } // A grant never makes an unsafe state safe, not even of zero
+    headroomTask tasks[SAFETY_MAX_THREADS];
+    whatIfTask guided;
+    int *ints;
+    long long *sortedNeeds; // Packed (need,process), ascending per resource
+    headroomLayout(state,proc,(char*)workspace,tasks,&guided,&ints,&sortedNeeds);
+    if (proc >= 0) { // One row: a few guided re-checks cost less than a sweep per resource
+        guided.state = state;
+        guidedHeadroom(&guided,proc,headroom,ints);
+        return BANKER_OK;
+    }
+    int *needStart = ints;
+    int *allocStart = needStart + cols+1;
+    int *unsatisfied = allocStart + cols+1;
+    int *fill = unsatisfied + rows;
+    memset(ints,0,sizeof(int)*(2*((size_t)cols+1) + (size_t)rows));
+    for (int i = 0; i < rows; ++i) { // Counted per resource first, offsets are prefix sums
+        int first = state->isSparse ? state->rowStart[i] : 0;
+        int last = state->isSparse ? state->rowStart[i+1] : cols;
+        for (int e = first; e < last; ++e) {
+            int res = state->isSparse ? state->entryCol[e] : e;
+            int need = state->isSparse ? state->entryNeed[e] : state->needRows[i][e];
+            int alloc = state->isSparse ? state->entryAlloc[e] : state->allocRows[i][e];
+            if (need > state->available[res]) { ++needStart[res+1]; ++unsatisfied[i]; }
+            if (alloc > 0) { ++allocStart[res+1]; } // Breakpoints of sparse sweeps
+        }
+    }
+    for (int j = 0; j < cols; ++j) {
+        needStart[j+1] += needStart[j];
+        allocStart[j+1] += allocStart[j];
+    }
+    memcpy(fill,needStart,sizeof(int)*(size_t)cols);
+    for (int i = 0; i < rows; ++i) {
+        int first = state->isSparse ? state->rowStart[i] : 0;
+        int last = state->isSparse ? state->rowStart[i+1] : cols;
+        for (int e = first; e < last; ++e) {
+            int res = state->isSparse ? state->entryCol[e] : e;
+            int need = state->isSparse ? state->entryNeed[e] : state->needRows[i][e];
+            if (need > state->available[res]) { sortedNeeds[fill[res]++] = ((long long)need << 32) | i; }
+        }
+    }
+    for (int j = 0; j < cols; ++j) { qsort(sortedNeeds + needStart[j],(size_t)(needStart[j+1] - needStart[j]),sizeof(long long),compareThresholds); }
+
+    // Resources are independent sweeps, so threads take interleaved shares of them (each writes only its own headroom columns)
+    int taskCount = (state->threads < cols) ? state->threads : cols;
+    for (int t = 0; t < taskCount; ++t) {
+        tasks[t].state = state;
+        tasks[t].sortedNeeds = sortedNeeds;
+        tasks[t].needStart = needStart;
+        tasks[t].unsatisfied = unsatisfied;
+        tasks[t].allocStart = allocStart;
+        tasks[t].headroom = headroom;
+        tasks[t].first = t;
+        tasks[t].step = taskCount;
+    }
+    pthread_t threads[SAFETY_MAX_THREADS];
+    int started[SAFETY_MAX_THREADS] = {0};
+    for (int t = 1; t < taskCount; ++t) { started[t] = (pthread_create(&threads[t],NULL,headroomWorker,&tasks[t]) == 0); }
+    if (taskCount > 0) { headroomWorker(&tasks[0]); }
+    for (int t = 1; t < taskCount; ++t) {
+        if (started[t]) { pthread_join(threads[t],NULL); }
+        else { headroomWorker(&tasks[t]); }
+    }
+    return BANKER_OK;
+}
+size_t bankerHeadroomWorkspace(const bankerState *state, int proc) {
+    return headroomLayout(state,proc,NULL,NULL,NULL,NULL,NULL);
+}
+int bankerRows(const bankerState *state) { return state->rowCount; }
+int bankerCols(const bankerState *state) { return state->colCount; }
+int bankerRowCapacity(const bankerState *state) { return state->rowCapacity; }
+int bankerColCapacity(const bankerState *state) { return state->colCapacity; }
+int bankerFlags(const bankerState *state) { return state->flags; }
+int bankerIsSafe(const bankerState *state) { return state->orderIsSafe; }
+int bankerQueued(const bankerState *state) { return state->queued; }
+const int *bankerOrder(const bankerState *state) { return state->order; }
+unsigned int bankerOrderVersion(const bankerState *state) { return state->orderVersion; }
+const int *bankerFinalAvailable(const bankerState *state) { return state->work; }
+int bankerUsesNarrow(const bankerState *state) { return state->narrowActive; }
+int bankerIsSparse(const bankerState *state) { return state->isSparse; }
+int bankerEntries(const bankerState *state) { return state->entryCount; }
+void bankerGetCounters(const bankerState *state, bankerCounters *counters) {
+#if BANKER_STATS
+    *counters = state->counters;
+#else
+    (void)state;
+    memset(counters,0,sizeof(*counters));
+#endif
+}
+static int checkLoaded(bankerState *state, int *availableCopy, int *order) {
+    if (state->isSparse) { return findSafeSequenceSparse(state,availableCopy,order); }
+    return findSafeSequence(state,state->needRows,state->allocRows,availableCopy,state->rowCount,state->colCount,order);
+}
+static int entryFits(const bankerState *state, int proc, const int *available) { // Zero needs (no entry) always fit
+    for (int e = state->rowStart[proc]; e < state->rowStart[proc+1]; ++e) {
+        if (state->entryNeed[e] > available[state->entryCol[e]]) { return 0; }
+    }
+    return 1;
+}
+static void entryAdd(const bankerState *state, int proc, int *available) {
+    for (int e = state->rowStart[proc]; e < state->rowStart[proc+1]; ++e) { available[state->entryCol[e]] += state->entryAlloc[e]; }
+}
+static int procValue(const bankerState *state, int proc, int res, int isAllocated) { // Sparse rows hold few entries, linear scan (no entry means zero)
+    if (!state->isSparse) { return isAllocated ? state->allocRows[proc][res] : state->needRows[proc][res]; }
+    for (int e = state->rowStart[proc]; e < state->rowStart[proc+1] && state->entryCol[e] <= res; ++e) {
+        if (state->entryCol[e] == res) { return isAllocated ? state->entryAlloc[e] : state->entryNeed[e]; }
+    }
+    return 0;
+}
+static void moveAllocation(bankerState *state, int proc, const int *amounts, int direction) { // Checked amounts only touch resources with need (grant) or allocation (return), so sparse ones always have an entry
+    for (int j = 0; j < state->colCount; ++j) { state->available[j] -= direction*amounts[j]; }
+    if (state->isSparse) {
+        for (int e = state->rowStart[proc]; e < state->rowStart[proc+1]; ++e) {
+            state->entryAlloc[e] += direction*amounts[state->entryCol[e]];
+            state->entryNeed[e] -= direction*amounts[state->entryCol[e]];
+        }
+        return;
+    }
+    for (int j = 0; j < state->colCount; ++j) {
+        state->allocRows[proc][j] += direction*amounts[j];
+        state->needRows[proc][j] -= direction*amounts[j];
+    }
+    syncNarrowRow(state,proc);
+}
+
+
+
+//// Worklist safety check
+static int findSafeSequence(bankerState *state, int **neededAllocation, int **currentlyAllocated, int *availableCopy, int rowCount, int colCount, int *order) { // Worklist safety check, each (process,resource) need is compared ~once. Returns amount of processes queued into order
+    // Row phases are split into state->threads contiguous shares when big enough, per-share column counts keep the threshold layout identical to one thread
+    int threads = state->threads;
+    int keyed = (state->flags & BANKER_PRIORITY) != 0; // Smallest priority key ready process first (min-heap of packed keys)
+    int basicPriority = (state->flags & BANKER_LOWEST_FIRST) && !keyed; // Lowest index ready process first (min-heap)
+    int rounds = (state->flags & BANKER_ROUNDS) && !basicPriority && !keyed; // Sequence built in rounds, same for any thread count
+    int rowThreads = (threads < rowCount) ? threads : rowCount;
+    if (rowThreads < 1 || (long long)rowCount*colCount < SAFETY_MIN_WORK) { rowThreads = 1; } // Not worth starting threads
+
+    // Count unsatisfied resources per process (need > available), and how many thresholds each resource will hold. Scratch comes from state arena
+    int *pendingRes = state->pendingRes; // Unsatisfied resource count per process
+    int *readyQueue = state->readyQueue; // Ready processes (FIFO, or min-heap with basicPriority)
+    int *resStart = state->bounds; // resStart[k]..resStart[k+1] is the threshold range for resource k
+    int *resCursor = state->bounds + colCount + 1; // Next threshold (not yet satisfied) for resource k
+    int *shareCounts = state->shareCounts; // shareCounts[t*cols+k], per-share column counts, then write cursors
+    memset(resStart,0,sizeof(int)*(2*(size_t)colCount+1));
+    if (rowThreads > 1) { memset(shareCounts,0,sizeof(int)*(size_t)rowThreads*colCount); }
+
+    safetyTask tasks[SAFETY_MAX_THREADS];
+    safetyTask baseTask = {0};
+    baseTask.need = neededAllocation;
+    baseTask.alloc = currentlyAllocated;
+    baseTask.available = availableCopy;
+    baseTask.colCount = colCount;
+    baseTask.pendingRes = pendingRes;
+    baseTask.resStart = resStart;
+    baseTask.resCursor = resCursor;
+    baseTask.width = widthKernelsFor(state,colCount);
+    for (int t = 0; t < rowThreads; ++t) {
+        tasks[t] = baseTask;
+        tasks[t].phase = SAFETY_PHASE_COUNT;
+        tasks[t].first = (int)((long long)rowCount*t/rowThreads);
+        tasks[t].last = (int)((long long)rowCount*(t+1)/rowThreads);
+        tasks[t].colCounts = (rowThreads == 1) ? resStart+1 : shareCounts+t*colCount; // One share counts straight into resStart
+    }
+    runSafetyTasks(tasks,rowThreads);
+    for (int t = 0; t < rowThreads && rowThreads > 1; ++t) { // Sum share counts into resStart
+        for (int j = 0; j < colCount; ++j) { resStart[j+1] += shareCounts[t*colCount+j]; }
+    }
+
+    int readyHead = 0; // FIFO head (unused with basicPriority)
+    int readyCount = 0; // FIFO tail, or heap size with basicPriority
+    int queued = 0;
+    for (int i = 0; i < rowCount; ++i) {
+        if (pendingRes[i] != 0) { continue; } // Process can not run yet
+        if (rounds) { order[queued++] = i; } // First round, ascending index
+        else if (keyed) { keyPushMin(state->readyKeys,&readyCount,readyKey(state,i)); }
+        else if (basicPriority) { heapPushMin(readyQueue,&readyCount,i); } 
+        else { readyQueue[readyCount++] = i; }
+    }
+    int initialReady = rounds ? queued : readyCount; // Rows that fit before anything was released (counters)
+    for (int j = 0; j < colCount; ++j) { // Prefix sum counts into start offsets
+        resStart[j+1] += resStart[j];
+        resCursor[j] = resStart[j];
+    }
+    int thresholdCount = resStart[colCount]; // Total unsatisfied (process,resource) pairs
+
+    // Per-resource orderings of needs, packed as (need << 32 | process) so a plain sort orders by need
+    long long *thresholds = state->thresholds; // Sized for every pair unsatisfied
+    if (thresholdCount > 0) {
+        for (int j = 0; j < colCount && rowThreads > 1; ++j) { // Share t writes after shares 0..t-1 within each resource, same layout as one thread
+            int cursor = resStart[j];
+            for (int t = 0; t < rowThreads; ++t) {
+                int count = shareCounts[t*colCount+j];
+                shareCounts[t*colCount+j] = cursor;
+                cursor += count;
+            }
+        }
+        for (int t = 0; t < rowThreads; ++t) {
+            tasks[t].phase = SAFETY_PHASE_FILL;
+            tasks[t].thresholds = thresholds;
+            tasks[t].colCounts = (rowThreads == 1) ? resCursor : shareCounts+t*colCount;
+        }
+        runSafetyTasks(tasks,rowThreads);
+
+        int sortThreads = (threads < colCount) ? threads : colCount; // Whole resources are sorted per thread
+        if (thresholdCount < SAFETY_MIN_WORK) { sortThreads = 1; }
+        int nextColumn = 0;
+        for (int t = 0; t < sortThreads; ++t) {
+            tasks[t] = baseTask;
+            tasks[t].phase = SAFETY_PHASE_SORT;
+            tasks[t].thresholds = thresholds;
+            tasks[t].nextColumn = &nextColumn;
+        }
+        runSafetyTasks(tasks,sortThreads);
+        for (int j = 0; j < colCount; ++j) { resCursor[j] = resStart[j]; } // Reset cursor to the smallest need
+    }
+
+    if (rounds) { // Every ready process completes in the same round, waking the next round (sorted, so any thread count gives the same order)
+        int roundStart = 0;
+        while (roundStart < queued) {
+            int roundSize = queued - roundStart;
+            int wokenCount = 0;
+            int colThreads = (threads < colCount) ? threads : colCount; // Each resource column owned by one thread
+            if (colThreads < 1 || (long long)roundSize*colCount < SAFETY_MIN_WORK) { colThreads = 1; }
+            for (int t = 0; t < colThreads; ++t) {
+                tasks[t] = baseTask;
+                tasks[t].phase = SAFETY_PHASE_RELEASE;
+                tasks[t].first = (int)((long long)colCount*t/colThreads);
+                tasks[t].last = (int)((long long)colCount*(t+1)/colThreads);
+                tasks[t].thresholds = thresholds;
+                tasks[t].round = order+roundStart;
+                tasks[t].roundSize = roundSize;
+                tasks[t].woken = order+queued; // Next round is appended straight into order
+                tasks[t].wokenCount = &wokenCount;
+            }
+            runSafetyTasks(tasks,colThreads);
+            qsort(order+queued,wokenCount,sizeof(int),compareInts);
+            roundStart = queued;
+            queued += wokenCount;
+        }
+    }
+
+    // Drain ready processes, releasing their resources and waking any process whose last unsatisfied need is now met
+    while (!rounds && readyHead < readyCount) { // Heaps never advance readyHead, so this is 'heap not empty' for them
+        int proc = keyed ? (int)(keyPopMin(state->readyKeys,&readyCount) & 0xFFFFFFFF) : (basicPriority ? heapPopMin(readyQueue,&readyCount) : readyQueue[readyHead++]);
+        order[queued++] = proc; // Process can complete in position 'queued'
+        if (baseTask.width != NULL) { baseTask.width->add(availableCopy,currentlyAllocated[proc]); } // Process completes and releases resources
+        else { ROW_KERNELS.add(availableCopy,currentlyAllocated[proc],colCount); }
+        if (thresholdCount == 0) { continue; } // Every process was ready from the start, nothing to wake
+        for (int j = 0; j < colCount; ++j) {
+            if (currentlyAllocated[proc][j] == 0) { continue; } // Resource did not grow, no new needs met
+            while (resCursor[j] < resStart[j+1] && (int)(thresholds[resCursor[j]] >> 32) <= availableCopy[j]) { // Advance past every need now satisfied
+                int waiting = (int)(thresholds[resCursor[j]] & 0xFFFFFFFF);
+                if (--pendingRes[waiting] == 0) { // All of process's needs met, becomes ready
+                    if (keyed) { keyPushMin(state->readyKeys,&readyCount,readyKey(state,waiting)); }
+                    else if (basicPriority) { heapPushMin(readyQueue,&readyCount,waiting); } 
+                    else { readyQueue[readyCount++] = waiting; }
+                }
+                ++resCursor[j];
+            }
+        }
+    }
+
+    STAT_ADD(state,checks,1);
+    STAT_ADD(state,rowCompares,rowCount);
+    STAT_ADD(state,earlyExits,rowCount - initialReady);
+    STAT_ADD(state,needWakes,countWakes(resStart,resCursor,colCount));
+    return queued;
+}
+static int findSafeSequenceSparse(bankerState *state, int *availableCopy, int *order) { // findSafeSequence over entries, zero needs are never unsatisfied so work scales with entries, not rows*cols
+    int rowCount = state->rowCount;
+    int colCount = state->colCount;
+    int keyed = (state->flags & BANKER_PRIORITY) != 0;
+    int basicPriority = (state->flags & BANKER_LOWEST_FIRST) && !keyed;
+    int rounds = (state->flags & BANKER_ROUNDS) && !basicPriority && !keyed;
+    int *rowStart = state->rowStart;
+    int *entryCol = state->entryCol;
+    int *entryAlloc = state->entryAlloc;
+    int *entryNeed = state->entryNeed;
+    int *pendingRes = state->pendingRes;
+    int *readyQueue = state->readyQueue;
+    int *resStart = state->bounds;
+    int *resCursor = state->bounds + colCount + 1;
+    long long *thresholds = state->thresholds; // Sized for every entry unsatisfied
+    memset(resStart,0,sizeof(int)*(2*(size_t)colCount+1));
+
+    // Count unsatisfied entries per process and per resource, queue processes with none
+    int readyHead = 0;
+    int readyCount = 0;
+    int queued = 0;
+    for (int i = 0; i < rowCount; ++i) {
+        int count = 0;
+        for (int e = rowStart[i]; e < rowStart[i+1]; ++e) {
+            if (entryNeed[e] > availableCopy[entryCol[e]]) {
+                ++count;
+                ++resStart[entryCol[e]+1];
+            }
+        }
+        pendingRes[i] = count;
+        if (count != 0) { continue; }
+        if (rounds) { order[queued++] = i; }
+        else if (keyed) { keyPushMin(state->readyKeys,&readyCount,readyKey(state,i)); }
+        else if (basicPriority) { heapPushMin(readyQueue,&readyCount,i); }
+        else { readyQueue[readyCount++] = i; }
+    }
+    int initialReady = rounds ? queued : readyCount;
+    for (int j = 0; j < colCount; ++j) {
+        resStart[j+1] += resStart[j];
+        resCursor[j] = resStart[j];
+    }
+    int thresholdCount = resStart[colCount];
+
+    // Same packed (need,process) keys and per-resource sort as the dense check, so sequences match
+    if (thresholdCount > 0) {
+        for (int i = 0; i < rowCount; ++i) {
+            if (pendingRes[i] == 0) { continue; }
+            for (int e = rowStart[i]; e < rowStart[i+1]; ++e) {
+                if (entryNeed[e] > availableCopy[entryCol[e]]) { thresholds[resCursor[entryCol[e]]++] = ((long long)entryNeed[e] << 32) | i; }
+            }
+        }
+        for (int j = 0; j < colCount; ++j) {
+            qsort(thresholds+resStart[j],resStart[j+1]-resStart[j],sizeof(long long),compareThresholds);
+            resCursor[j] = resStart[j];
+        }
+    }
+
+    if (rounds) { // Whole round releases, then every resource advances (woken sorted, as in the threaded release phase)
+        int roundStart = 0;
+        while (roundStart < queued) {
+            int wokenCount = 0;
+            for (int r = roundStart; r < queued; ++r) { entryAdd(state,order[r],availableCopy); }
+            for (int j = 0; j < colCount; ++j) {
+                while (resCursor[j] < resStart[j+1] && (int)(thresholds[resCursor[j]] >> 32) <= availableCopy[j]) {
+                    int waiting = (int)(thresholds[resCursor[j]] & 0xFFFFFFFF);
+                    if (--pendingRes[waiting] == 0) { order[queued+wokenCount++] = waiting; }
+                    ++resCursor[j];
+                }
+            }
+            qsort(order+queued,wokenCount,sizeof(int),compareInts);
+            roundStart = queued;
+            queued += wokenCount;
+        }
+    }
+
+    while (!rounds && readyHead < readyCount) { // Heaps never advance readyHead, so this is 'heap not empty' for them
+        int proc = keyed ? (int)(keyPopMin(state->readyKeys,&readyCount) & 0xFFFFFFFF) : (basicPriority ? heapPopMin(readyQueue,&readyCount) : readyQueue[readyHead++]);
+        order[queued++] = proc;
+        for (int e = rowStart[proc]; e < rowStart[proc+1]; ++e) { // Release, then wake in ascending resource order (as dense drain)
+            int j = entryCol[e];
+            if (entryAlloc[e] == 0) { continue; }
+            availableCopy[j] += entryAlloc[e];
+            while (resCursor[j] < resStart[j+1] && (int)(thresholds[resCursor[j]] >> 32) <= availableCopy[j]) {
+                int waiting = (int)(thresholds[resCursor[j]] & 0xFFFFFFFF);
+                if (--pendingRes[waiting] == 0) {
+                    if (keyed) { keyPushMin(state->readyKeys,&readyCount,readyKey(state,waiting)); }
+                    else if (basicPriority) { heapPushMin(readyQueue,&readyCount,waiting); }
+                    else { readyQueue[readyCount++] = waiting; }
+                }
+                ++resCursor[j];
+            }
+        }
+    }
+
+    STAT_ADD(state,checks,1);
+    STAT_ADD(state,rowCompares,rowCount);
+    STAT_ADD(state,earlyExits,rowCount - initialReady);
+    STAT_ADD(state,needWakes,countWakes(resStart,resCursor,colCount));
+    return queued;
+}
+static void foldSlack(const bankerState *state, int proc, int *work, int *slack, int isFirst) {
+    int cols = state->colCount;
+    if (isFirst) { memcpy(slack,work,sizeof(int)*(size_t)cols); } // Work only grows, first vector bounds every zero need
+    if (state->isSparse) {
+        for (int e = state->rowStart[proc]; e < state->rowStart[proc+1]; ++e) {
+            int res = state->entryCol[e];
+            if (work[res] - state->entryNeed[e] < slack[res]) { slack[res] = work[res] - state->entryNeed[e]; }
+        }
+        entryAdd(state,proc,work);
+        return;
+    }
+    const int *need = state->needRows[proc];
+    for (int j = 0; j < cols; ++j) { if (work[j] - need[j] < slack[j]) { slack[j] = work[j] - need[j]; } }
+    ROW_KERNELS.add(work,state->allocRows[proc],cols);
+}
+static void *whatIfWorker(void *arg) { // Candidates of a share reuse the same buffers
+    whatIfTask *task = (whatIfTask*)arg;
+    for (int k = task->first; k < task->pendingCount; k += task->step) {
+        int i = task->pending[k];
+        task->results[i] = guidedCheck(task,task->procs[i],task->requests + (size_t)i*task->requestStride) ? BANKER_OK : BANKER_DENY_UNSAFE;
+    }
+    return NULL;
+}
+static int guidedCheck(whatIfTask *task, int proc, const int *request) { // Request only lowers work until proc finishes, so the baseline order mostly still fits, misfits wait on the resource they lack
+    const bankerState *state = task->state;
+    int rows = state->rowCount;
+    int cols = state->colCount;
+    int *work = task->work;
+    int *waitingRoot = work + cols;
+    int *finished = waitingRoot + cols; // Stack of processes that can finish but have not released yet
+    int procPos = state->orderPos[proc];
+    int waitingTotal = 0;
+    for (int j = 0; j < cols; ++j) {
+        work[j] = state->available[j] - request[j];
+        waitingRoot[j] = -1;
+    }
+    for (int k = 0; k < rows; ++k) {
+        if (k > procPos && waitingTotal == 0) { return 1; } // Everything up to proc finished, work is back on the baseline sequence
+        int next = state->order[k];
+        int blockedNeed = 0;
+        int blocked = blockingResource(state,next,proc,request,work,&blockedNeed);
+        if (blocked >= 0) {
+            waitPush(task,blocked,((long long)blockedNeed << 32) | next);
+            ++waitingTotal;
+            continue;
+        }
+        int finishedCount = 0;
+        finished[finishedCount++] = next;
+        while (finishedCount > 0) { // Release, then wake waiting processes whose resource is now covered (work only grows, so each wait is exact)
+            int done = finished[--finishedCount];
+            int first = 0; // Resources done may have raised: all (dense), its entries (sparse, request is inside them)
+            int last = cols;
+            if (state->isSparse) {
+                entryAdd(state,done,work);
+                first = state->rowStart[done];
+                last = state->rowStart[done+1];
+            }
+            else { ROW_KERNELS.add(work,state->allocRows[done],cols); }
+            if (done == proc) { for (int j = 0; j < cols; ++j) { work[j] += request[j]; } }
+            for (int r = first; r < last; ++r) {
+                int res = state->isSparse ? state->entryCol[r] : r;
+                while (waitingRoot[res] >= 0 && (int)(task->waitKeys[waitingRoot[res]] >> 32) <= work[res]) {
+                    int waiter = (int)(waitPop(task,res) & 0xFFFFFFFF);
+                    --waitingTotal;
+                    blocked = blockingResource(state,waiter,proc,request,work,&blockedNeed);
+                    if (blocked < 0) { finished[finishedCount++] = waiter; continue; }
+                    waitPush(task,blocked,((long long)blockedNeed << 32) | waiter);
+                    ++waitingTotal;
+                }
+            }
+        }
+    }
+    return (waitingTotal == 0);
+}
+static int blockingResource(const bankerState *state, int proc, int requestingProc, const int *request, const int *work, int *blockedNeed) {
+    int cols = state->colCount;
+    int lowered = (proc == requestingProc); // Requesting process needs request less (request <= need, so sparse entries cover it)
+    if (state->isSparse) {
+        for (int e = state->rowStart[proc]; e < state->rowStart[proc+1]; ++e) {
+            int res = state->entryCol[e];
+            *blockedNeed = state->entryNeed[e] - (lowered ? request[res] : 0);
+            if (*blockedNeed > work[res]) { return res; }
+        }
+        return -1;
+    }
+    const int *need = state->needRows[proc];
+    if (!lowered && ROW_KERNELS.fits(need,work,cols)) { return -1; }
+    for (int j = 0; j < cols; ++j) {
+        *blockedNeed = need[j] - (lowered ? request[j] : 0);
+        if (*blockedNeed > work[j]) { return j; }
+    }
+    return -1;
+}
+static void waitPush(whatIfTask *task, int res, long long key) { // Process in low half of key is the node, it waits on no other resource meanwhile
+    int cols = task->state->colCount;
+    int rows = task->state->rowCount;
+    int *waitingRoot = task->work + cols;
+    int *left = waitingRoot + cols + rows;
+    int *right = left + rows;
+    int *rank = right + rows; // Right spine length
+    int node = (int)(key & 0xFFFFFFFF);
+    task->waitKeys[node] = key;
+    left[node] = -1;
+    right[node] = -1;
+    rank[node] = 1;
+    waitingRoot[res] = waitMerge(task,waitingRoot[res],node);
+}
+static long long waitPop(whatIfTask *task, int res) {
+    int cols = task->state->colCount;
+    int rows = task->state->rowCount;
+    int *waitingRoot = task->work + cols;
+    int *left = waitingRoot + cols + rows;
+    int *right = left + rows;
+    int top = waitingRoot[res];
+    waitingRoot[res] = waitMerge(task,left[top],right[top]);
+    return task->waitKeys[top];
+}
+static int waitMerge(whatIfTask *task, int first, int second) { // Leftist heap: right spine never longer than left, so merges stay logarithmic
+    if (first < 0) { return second; }
+    if (second < 0) { return first; }
+    int rows = task->state->rowCount;
+    int *left = task->work + 2*task->state->colCount + rows;
+    int *right = left + rows;
+    int *rank = right + rows;
+    if (task->waitKeys[second] < task->waitKeys[first]) {
+        int swap = first;
+        first = second;
+        second = swap;
+    }
+    right[first] = waitMerge(task,right[first],second);
+    if (left[first] < 0 || rank[left[first]] < rank[right[first]]) {
+        int swap = left[first];
+        left[first] = right[first];
+        right[first] = swap;
+    }
+    rank[first] = 1 + ((right[first] < 0) ? 0 : rank[right[first]]);
+    return first;
+}
+static void guidedHeadroom(whatIfTask *task, int proc, int *headroom, int *scratch) { // Grants up to the prefix slack of proc keep the baseline sequence (see bankerWhatIf), most answers sit on or near it
+    const bankerState *state = task->state;
+    int cols = state->colCount;
+    int *request = scratch;
+    int *sweep = request + cols; // Work vector | slack
+    int *slack = sweep + cols;
+    int pos = state->orderPos[proc];
+    memset(request,0,sizeof(int)*(size_t)cols);
+    memcpy(sweep,state->available,sizeof(int)*(size_t)cols);
+    for (int k = 0; k < pos; ++k) { foldSlack(state,state->order[k],sweep,slack,k == 0); }
+    for (int res = 0; res < cols; ++res) {
+        int high = procValue(state,proc,res,0); // Largest grant not known unsafe
+        if (high > state->available[res]) { high = state->available[res]; }
+        int low = (pos == 0 || high < slack[res]) ? high : slack[res]; // Largest grant known safe (first process finishes before anything else needs work)
+        int step = 1;
+        while (low < high) { // Doubling from the proven bound, bisection once a step is unsafe
+            int grant = (step <= high - low) ? low + step : high;
+            request[res] = grant;
+            if (guidedCheck(task,proc,request)) {
+                low = grant;
+                if (step < (1 << 30)) { step *= 2; }
+            } else {
+                high = grant - 1;
+                step = 1;
+            }
+        }
+        request[res] = 0;
+        headroom[res] = low;
+    }
+}
+static void guidedLayout(const bankerState *state, char *base, size_t *offset, whatIfTask *task) {
+    size_t rows = (size_t)state->rowCapacity;
+    size_t cols = (size_t)state->colCapacity;
+    int *work = (int*)arenaTake(base,offset,sizeof(int)*(2*cols + 4*rows));
+    long long *waitKeys = (long long*)arenaTake(base,offset,sizeof(long long)*rows);
+    if (base != NULL) {
+        task->work = work;
+        task->waitKeys = waitKeys;
+    }
+}
+static size_t whatIfLayout(const bankerState *state, int count, char *base, whatIfTask *tasks, long long **keys, int **ints) { // Sized by capacities and threads, so one workspace serves every call until those grow
+    size_t offset = 0;
+    long long *keyBlock = (long long*)arenaTake(base,&offset,sizeof(long long)*((size_t)count+1));
+    int *intBlock = (int*)arenaTake(base,&offset,sizeof(int)*(2*((size_t)count+1) + 2*(size_t)state->colCapacity));
+    if (base != NULL) {
+        *keys = keyBlock;
+        *ints = intBlock;
+    }
+    for (int t = 0; t < state->threads; ++t) { guidedLayout(state,base,&offset,(base == NULL) ? NULL : &tasks[t]); }
+    return offset;
+}
+static size_t headroomLayout(const bankerState *state, int proc, char *base, headroomTask *tasks, whatIfTask *guided, int **ints, long long **sortedNeeds) {
+    size_t rows = (size_t)state->rowCapacity;
+    size_t cols = (size_t)state->colCapacity;
+    size_t entries = (size_t)state->entryCapacity;
+    size_t offset = 0;
+    if (proc >= 0) {
+        guidedLayout(state,base,&offset,guided);
+        int *intBlock = (int*)arenaTake(base,&offset,sizeof(int)*3*cols);
+        if (base != NULL) { *ints = intBlock; }
+        return offset;
+    }
+    int *intBlock = (int*)arenaTake(base,&offset,sizeof(int)*(3*(cols+1) + rows));
+    long long *needBlock = (long long*)arenaTake(base,&offset,sizeof(long long)*((state->isSparse ? entries : rows*cols) + 1)); // Every need above available at worst
+    if (base != NULL) {
+        *ints = intBlock;
+        *sortedNeeds = needBlock;
+    }
+    int taskCount = (state->threads < state->colCapacity) ? state->threads : state->colCapacity;
+    for (int t = 0; t < taskCount; ++t) {
+        size_t tail = state->isSparse ? 2*entries : 3*rows+1; // O(rows) for dense, columns are covered one at a time
+        int *buffer = (int*)arenaTake(base,&offset,sizeof(int)*(3*rows + 3*cols + tail));
+        long long *ready = (long long*)arenaTake(base,&offset,sizeof(long long)*(rows+1));
+        if (base != NULL) {
+            tasks[t].buffer = buffer;
+            tasks[t].ready = ready;
+        }
+    }
+    return offset;
+}
+static void *headroomWorker(void *arg) {
+    headroomTask *task = (headroomTask*)arg;
+    for (int res = task->first; res < task->state->colCount; res += task->step) { headroomSweep(task,res); }
+    return NULL;
+}
+static void headroomSweep(headroomTask *task, int res) { // Granting x of res to P leaves available[res] - x until P finishes, and P finishes iff its need fits available + allocated of closure C(x) without P
+    const bankerState *state = task->state;
+    int rows = state->rowCount;
+    int cols = state->colCount;
+    const int *available = state->available;
+    if (available[res] == 0) { return; } // Nothing to grant, column stays 0
+    int *unsatisfied = task->buffer; // Other resources with need above work, per process
+    int *level = unsatisfied + rows; // Largest x at which the first k+1 processes of closure order are all in C(x)
+    int *orderPos = level + rows; // Position in closure order
+    int *next = orderPos + rows; // Per resource, next sortedNeeds key not yet covered by work
+    int *fill = next + cols; // Sparse: per resource, next free breakpoint
+    int *held = fill + cols; // Per resource, allocated over closure so far
+    int *closure = held + cols; // Dense: closure order (process at each position)
+    int *joinedAt = held + cols; // Sparse: breakpoints per resource (from allocStart), closure size when an allocation of it joined
+    int *allocSum = joinedAt + task->allocStart[cols]; // Sparse: allocated of that resource over closure so far, per breakpoint
+
+    // Bottleneck sweep: of the processes fitting every other resource, the one with least need of res joins next, at level
+    //     available[res] + allocated[res] of closure - need (never above the previous level), so levels only fall
+    int readyCount = 0;
+    memcpy(unsatisfied,task->unsatisfied,sizeof(int)*(size_t)rows);
+    for (int k = task->needStart[res]; k < task->needStart[res+1]; ++k) { --unsatisfied[task->sortedNeeds[k] & 0xFFFFFFFF]; }
+    for (int i = 0; i < rows; ++i) {
+        orderPos[i] = rows; // Never joins (only possible if state changed since its check)
+        if (unsatisfied[i] == 0) { keyPushMin(task->ready,&readyCount,((long long)(state->isSparse ? procValue(state,i,res,0) : state->needRows[i][res]) << 32) | i); }
+    }
+    for (int j = 0; j < cols; ++j) {
+        next[j] = task->needStart[j];
+        fill[j] = task->allocStart[j];
+        held[j] = 0;
+    }
+    int joined = 0;
+    int heldRes = 0; // Allocated of res over closure
+    int currentLevel = available[res]; // No grant can pass available
+    while (readyCount > 0) {
+        long long key = keyPopMin(task->ready,&readyCount);
+        int proc = (int)(key & 0xFFFFFFFF);
+        int joinLevel = available[res] + heldRes - (int)(key >> 32);
+        if (joinLevel < currentLevel) { currentLevel = (joinLevel > 0) ? joinLevel : 0; }
+        level[joined] = currentLevel;
+        if (!state->isSparse) { closure[joined] = proc; }
+        orderPos[proc] = joined++;
+        int first = state->isSparse ? state->rowStart[proc] : 0;
+        int last = state->isSparse ? state->rowStart[proc+1] : cols;
+        for (int e = first; e < last; ++e) { // Released allocation may cover more needs of other resources
+            int alloc = state->isSparse ? state->entryAlloc[e] : state->allocRows[proc][e];
+            if (alloc == 0) { continue; }
+            int col = state->isSparse ? state->entryCol[e] : e;
+            int sum = (held[col] += alloc);
+            if (state->isSparse) { // Breakpoint for sparseCovering
+                joinedAt[fill[col]] = joined;
+                allocSum[fill[col]++] = sum;
+            }
+            if (col == res) {
+                heldRes = sum;
+                continue;
+            }
+            while (next[col] < task->needStart[col+1] && (task->sortedNeeds[next[col]] >> 32) <= available[col] + sum) {
+                int waiter = (int)(task->sortedNeeds[next[col]++] & 0xFFFFFFFF);
+                if (--unsatisfied[waiter] == 0) { keyPushMin(task->ready,&readyCount,((long long)(state->isSparse ? procValue(state,waiter,res,0) : state->needRows[waiter][res]) << 32) | waiter); }
+            }
+        }
+    }
+
+    // Per process: shortest closure prefix covering its need (own allocation excluded), the level there bounds the grant
+    int *covering = closure + rows; // Dense: filled for every process by denseCovering
+    if (!state->isSparse) { denseCovering(task,res,joined); }
+    for (int i = 0; i < rows; ++i) {
+        int limit = state->isSparse ? procValue(state,i,res,0) : state->needRows[i][res];
+        if (limit > available[res]) { limit = available[res]; }
+        if (limit == 0) { continue; }
+        int needed = state->isSparse ? sparseCovering(task,i) : covering[i];
+        int grant = (needed == 0) ? limit : ((needed > joined) ? 0 : level[needed-1]);
+        task->headroom[(size_t)i*cols + res] = (grant < limit) ? grant : limit;
+    }
+}
+static void denseCovering(headroomTask *task, int res, int joined) { // Per resource, covered is monotonic in k (own allocation enters prefix and target together), the longest of those covers the row
+    const bankerState *state = task->state;
+    int rows = state->rowCount;
+    int cols = state->colCount;
+    const int *orderPos = task->buffer + 2*rows;
+    const int *closure = task->buffer + 3*rows + 3*cols;
+    int *covering = task->buffer + 4*rows + 3*cols;
+    int *prefix = covering + rows; // Allocated of one resource over first k processes of closure order (joined+1 values)
+    for (int i = 0; i < rows; ++i) { covering[i] = 0; }
+    for (int j = 0; j < cols; ++j) { // Only needs above available are short, sortedNeeds lists them ascending, so one walk along prefix serves them all
+        if (task->needStart[j] == task->needStart[j+1]) { continue; }
+        prefix[0] = 0;
+        for (int k = 0; k < joined; ++k) { prefix[k+1] = prefix[k] + state->allocRows[closure[k]][j]; }
+        int covered = 1; // Prefix covering shortfall of current key (joined+1 if never)
+        for (int e = task->needStart[j]; e < task->needStart[j+1]; ++e) {
+            int i = (int)(task->sortedNeeds[e] & 0xFFFFFFFF);
+            int shortfall = (int)(task->sortedNeeds[e] >> 32) - state->available[j];
+            while (covered <= joined && prefix[covered] < shortfall) { ++covered; }
+            if (covering[i] > joined || state->needRows[i][res] == 0) { continue; } // Never covered already, or no grant to bound
+            int own = state->allocRows[i][j];
+            int ownCovered = (own > 0 && orderPos[i] < covered) ? prefixCovered(prefix,covered,joined,shortfall + own) : covered;
+            if (ownCovered > covering[i]) { covering[i] = ownCovered; }
+        }
+    }
+}
+static int prefixCovered(const int *prefix, int low, int joined, int amount) { // Prefix sums ascend, binary search
+    int high = joined+1; // Past closure: never covered
+    while (low < high) {
+        int mid = low + (high - low)/2;
+        if (prefix[mid] >= amount) { high = mid; }
+        else { low = mid+1; }
+    }
+    return low;
+}
+static int sparseCovering(headroomTask *task, int proc) { // Each short resource searched in its own breakpoints, covering prefix is the longest of those
+    const bankerState *state = task->state;
+    int rows = state->rowCount;
+    int cols = state->colCount;
+    int orderPos = (task->buffer + 2*rows)[proc];
+    const int *fill = task->buffer + 3*rows + cols;
+    const int *joinedAt = fill + 2*cols;
+    const int *allocSum = joinedAt + task->allocStart[cols];
+    int needed = 0;
+    for (int e = state->rowStart[proc]; e < state->rowStart[proc+1] && needed <= rows; ++e) {
+        int col = state->entryCol[e];
+        int shortfall = state->entryNeed[e] - state->available[col];
+        if (shortfall <= 0) { continue; }
+        int own = state->entryAlloc[e];
+        int covered = coveredAt(joinedAt,allocSum,task->allocStart[col],fill[col],shortfall,rows);
+        if (own > 0 && orderPos < covered) { covered = coveredAt(joinedAt,allocSum,task->allocStart[col],fill[col],shortfall + own,rows); }
+        if (covered > needed) { needed = covered; }
+    }
+    return needed;
+}
+static int coveredAt(const int *joinedAt, const int *allocSum, int first, int last, int amount, int rows) { // Sums ascend (values > 0), binary search
+    int low = first;
+    int high = last;
+    while (low < high) {
+        int mid = low + (high - low)/2;
+        if (allocSum[mid] < amount) { low = mid+1; }
+        else { high = mid; }
+    }
+    return (low < last) ? joinedAt[low] : rows+1;
+}
+static void *safetyWorker(void *arg) { // Each phase only writes its own rows/columns (pendingRes decrements are atomic), so shares never conflict
+    safetyTask *task = (safetyTask*)arg;
+    if (task->phase == SAFETY_PHASE_COUNT && task->width != NULL) { task->width->countRows(task->need,task->available,task->colCounts,task->pendingRes,task->first,task->last); }
+    else if (task->phase == SAFETY_PHASE_FILL && task->width != NULL) { task->width->fillRows(task->need,task->available,task->pendingRes,task->thresholds,task->colCounts,task->first,task->last); }
+    else if (task->phase == SAFETY_PHASE_COUNT) {
+        for (int i = task->first; i < task->last; ++i) { task->pendingRes[i] = ROW_KERNELS.countExceeds(task->need[i],task->available,task->colCounts,task->colCount); }
+    }
+    else if (task->phase == SAFETY_PHASE_FILL) {
+        for (int i = task->first; i < task->last; ++i) {
+            if (task->pendingRes[i] == 0) { continue; } // Nothing unsatisfied for process
+            for (int j = 0; j < task->colCount; ++j) {
+                if (task->need[i][j] > task->available[j]) { task->thresholds[task->colCounts[j]++] = ((long long)task->need[i][j] << 32) | i; }
+            }
+        }
+    }
+    else if (task->phase == SAFETY_PHASE_SORT) { // Claim whole resources until none left (keys are unique, so result is the same for any split)
+        int j;
+        while ((j = __atomic_fetch_add(task->nextColumn,1,__ATOMIC_RELAXED)) < task->colCount) {
+            qsort(task->thresholds+task->resStart[j],task->resStart[j+1]-task->resStart[j],sizeof(long long),compareThresholds);
+        }
+    }
+    else if (task->phase == SAFETY_PHASE_RELEASE) {
+        int width = task->last - task->first;
+        for (int r = 0; r < task->roundSize; ++r) { ROW_KERNELS.add(task->available+task->first,task->alloc[task->round[r]]+task->first,width); } // Round completes, releases its resources
+        for (int j = task->first; j < task->last; ++j) {
+            while (task->resCursor[j] < task->resStart[j+1] && (int)(task->thresholds[task->resCursor[j]] >> 32) <= task->available[j]) { // Advance past every need now satisfied
+                int waiting = (int)(task->thresholds[task->resCursor[j]] & 0xFFFFFFFF);
+                if (__atomic_sub_fetch(&task->pendingRes[waiting],1,__ATOMIC_RELAXED) == 0) { task->woken[__atomic_fetch_add(task->wokenCount,1,__ATOMIC_RELAXED)] = waiting; } // Last need met, exactly one thread sees 0
+                ++task->resCursor[j];
+            }
+        }
+    }
+    return NULL;
+}
+static void runSafetyTasks(safetyTask *tasks, int taskCount) { // Task 0 runs on calling thread, a task whose thread fails to start runs here too (results do not depend on which thread runs it)
+    pthread_t threads[SAFETY_MAX_THREADS];
+    int started[SAFETY_MAX_THREADS] = {0};
+    for (int t = 1; t < taskCount; ++t) { started[t] = (pthread_create(&threads[t],NULL,safetyWorker,&tasks[t]) == 0); }
+    safetyWorker(&tasks[0]);
+    for (int t = 1; t < taskCount; ++t) {
+        if (started[t]) { pthread_join(threads[t],NULL); }
+        else { safetyWorker(&tasks[t]); }
+    }
+}
+static long long countWakes(const int *resStart, const int *resCursor, int colCount) {
+    long long wakes = 0;
+    for (int j = 0; j < colCount; ++j) { wakes += resCursor[j] - resStart[j]; }
+    return wakes;
+}
+static int compareInts(const void *a, const void *b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+static int compareThresholds(const void *a, const void *b) { // Orders packed keys ascending (need first, then process index)
+    long long x = *(const long long*)a;
+    long long y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+static void heapPushMin(int *heap, int *heapSize, int val) { // Sift-up insert into binary min-heap
+    int pos = (*heapSize)++;
+    while (pos > 0 && heap[(pos-1)/2] > val) { // Move parent down until val fits
+        heap[pos] = heap[(pos-1)/2];
+        pos = (pos-1)/2;
+    }
+    heap[pos] = val;
+}
+static int heapPopMin(int *heap, int *heapSize) { // Removes root of binary min-heap, sift-down last value
+    int top = heap[0];
+    int last = heap[--(*heapSize)];
+    int pos = 0;
+    while (2*pos+1 < *heapSize) { // While pos has a child
+        int child = 2*pos+1;
+        if (child+1 < *heapSize && heap[child+1] < heap[child]) { ++child; } // Smaller of the two children
+        if (heap[child] >= last) { break; }
+        heap[pos] = heap[child];
+        pos = child;
+    }
+    if (*heapSize > 0) { heap[pos] = last; }
+    return top;
+}
+static void keyPushMin(long long *heap, int *heapSize, long long key) { // Same sift-up as heapPushMin, for packed keys
+    int pos = (*heapSize)++;
+    while (pos > 0 && heap[(pos-1)/2] > key) {
+        heap[pos] = heap[(pos-1)/2];
+        pos = (pos-1)/2;
+    }
+    heap[pos] = key;
+}
+static long long readyKey(const bankerState *state, int proc) { // Multiply instead of shift, negative keys stay ordered below positive ones
+    return (long long)state->priorityKeys[proc]*4294967296LL + proc;
+}
+static long long keyPopMin(long long *heap, int *heapSize) { // Same sift-down as heapPopMin
+    long long top = heap[0];
+    long long last = heap[--(*heapSize)];
+    int pos = 0;
+    while (2*pos+1 < *heapSize) {
+        int child = 2*pos+1;
+        if (child+1 < *heapSize && heap[child+1] < heap[child]) { ++child; }
+        if (heap[child] >= last) { break; }
+        heap[pos] = heap[child];
+        pos = child;
+    }
+    if (*heapSize > 0) { heap[pos] = last; }
+    return top;
+}
+
+
+
+//// Row kernels
+static int rowFitsScalar(const int *need, const int *available, int colCount) { // Early exit on first need over available
+    for (int j = 0; j < colCount; ++j) {
+        if (need[j] > available[j]) { return 0; }
+    }
+    return 1;
+}
+static int rowCountExceedsScalar(const int *need, const int *available, int *colCounts, int colCount) { // Branch-free count of unsatisfied cols
+    int count = 0;
+    for (int j = 0; j < colCount; ++j) {
+        int exceeds = (need[j] > available[j]);
+        colCounts[j] += exceeds;
+        count += exceeds;
+    }
+    return count;
+}
+static void rowAddScalar(int *available, const int *row, int colCount) {
+    for (int j = 0; j < colCount; ++j) { available[j] += row[j]; }
+}
+static int rowSubtractScalar(int *result, const int *first, const int *second, int colCount) {
+    int negative = 0;
+    for (int j = 0; j < colCount; ++j) {
+        result[j] = first[j] - second[j];
+        negative |= (result[j] < 0);
+    }
+    return negative;
+}
+static int rowFits16Scalar(const short *need, const short *available, int colCount) {
+    for (int j = 0; j < colCount; ++j) {
+        if (need[j] > available[j]) { return 0; }
+    }
+    return 1;
+}
+static void rowAdd16Scalar(short *available, const short *row, int colCount) {
+    for (int j = 0; j < colCount; ++j) { available[j] = (short)(available[j] + row[j]); }
+}
+#if HAVE_X86_KERNELS
+// SSE2 kernels, 4 ints (or 8 shorts) per vector, scalar loop for remaining cols. Unaligned loads so any row/array works
+static __attribute__((target("sse2"))) int rowFitsSse2(const int *need, const int *available, int colCount) {
+    int j = 0;
+    for (; j + 4 <= colCount; j += 4) {
+        __m128i exceeds = _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(need+j)),_mm_loadu_si128((const __m128i*)(available+j)));
+        if (_mm_movemask_epi8(exceeds)) { return 0; }
+    }
+    return rowFitsScalar(need+j,available+j,colCount-j);
+}
+static __attribute__((target("sse2"))) int rowCountExceedsSse2(const int *need, const int *available, int *colCounts, int colCount) {
+    int count = 0;
+    int j = 0;
+    for (; j + 4 <= colCount; j += 4) {
+        __m128i exceeds = _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i*)(need+j)),_mm_loadu_si128((const __m128i*)(available+j))); // -1 per unsatisfied col
+        __m128i counts = _mm_loadu_si128((const __m128i*)(colCounts+j));
+        _mm_storeu_si128((__m128i*)(colCounts+j),_mm_sub_epi32(counts,exceeds));
+        count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(exceeds)));
+    }
+    return count + rowCountExceedsScalar(need+j,available+j,colCounts+j,colCount-j);
+}
+static __attribute__((target("sse2"))) void rowAddSse2(int *available, const int *row, int colCount) {
+    int j = 0;
+    for (; j + 4 <= colCount; j += 4) {
+        __m128i sum = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(available+j)),_mm_loadu_si128((const __m128i*)(row+j)));
+        _mm_storeu_si128((__m128i*)(available+j),sum);
+    }
+    rowAddScalar(available+j,row+j,colCount-j);
+}
+static __attribute__((target("sse2"))) int rowSubtractSse2(int *result, const int *first, const int *second, int colCount) {
+    __m128i signs = _mm_setzero_si128(); // OR of all results, sign bit set if any negative
+    int j = 0;
+    for (; j + 4 <= colCount; j += 4) {
+        __m128i diff = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(first+j)),_mm_loadu_si128((const __m128i*)(second+j)));
+        _mm_storeu_si128((__m128i*)(result+j),diff);
+        signs = _mm_or_si128(signs,diff);
+    }
+    return (_mm_movemask_ps(_mm_castsi128_ps(signs)) != 0) | rowSubtractScalar(result+j,first+j,second+j,colCount-j);
+}
+static __attribute__((target("sse2"))) int rowFits16Sse2(const short *need, const short *available, int colCount) {
+    int j = 0;
+    for (; j + 8 <= colCount; j += 8) {
+        __m128i exceeds = _mm_cmpgt_epi16(_mm_loadu_si128((const __m128i*)(need+j)),_mm_loadu_si128((const __m128i*)(available+j)));
+        if (_mm_movemask_epi8(exceeds)) { return 0; }
+    }
+    return rowFits16Scalar(need+j,available+j,colCount-j);
+}
+static __attribute__((target("sse2"))) void rowAdd16Sse2(short *available, const short *row, int colCount) {
+    int j = 0;
+    for (; j + 8 <= colCount; j += 8) {
+        __m128i sum = _mm_add_epi16(_mm_loadu_si128((const __m128i*)(available+j)),_mm_loadu_si128((const __m128i*)(row+j)));
+        _mm_storeu_si128((__m128i*)(available+j),sum);
+    }
+    rowAdd16Scalar(available+j,row+j,colCount-j);
+}
+// AVX2 kernels, 8 ints (or 16 shorts) per vector, SSE2 kernels handle remaining cols. Upper halves cleared before that tail call,
+//     gcc emits no vzeroupper on it and legacy SSE2 code after dirty uppers stalls (12-15 cols ran ~10x slower)
+static __attribute__((target("avx2"))) int rowFitsAvx2(const int *need, const int *available, int colCount) {
+    int j = 0;
+    for (; j + 8 <= colCount; j += 8) {
+        __m256i exceeds = _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(need+j)),_mm256_loadu_si256((const __m256i*)(available+j)));
+        if (_mm256_movemask_epi8(exceeds)) { return 0; }
+    }
+    _mm256_zeroupper();
+    return rowFitsSse2(need+j,available+j,colCount-j);
+}
+static __attribute__((target("avx2"))) int rowCountExceedsAvx2(const int *need, const int *available, int *colCounts, int colCount) {
+    int count = 0;
+    int j = 0;
+    for (; j + 8 <= colCount; j += 8) {
+        __m256i exceeds = _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(need+j)),_mm256_loadu_si256((const __m256i*)(available+j))); // -1 per unsatisfied col
+        __m256i counts = _mm256_loadu_si256((const __m256i*)(colCounts+j));
+        _mm256_storeu_si256((__m256i*)(colCounts+j),_mm256_sub_epi32(counts,exceeds));
+        count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(exceeds)));
+    }
+    _mm256_zeroupper();
+    return count + rowCountExceedsSse2(need+j,available+j,colCounts+j,colCount-j);
+}
+static __attribute__((target("avx2"))) void rowAddAvx2(int *available, const int *row, int colCount) {
+    int j = 0;
+    for (; j + 8 <= colCount; j += 8) {
+        __m256i sum = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(available+j)),_mm256_loadu_si256((const __m256i*)(row+j)));
+        _mm256_storeu_si256((__m256i*)(available+j),sum);
+    }
+    _mm256_zeroupper();
+    rowAddSse2(available+j,row+j,colCount-j);
+}
+static __attribute__((target("avx2"))) int rowSubtractAvx2(int *result, const int *first, const int *second, int colCount) {
+    __m256i signs = _mm256_setzero_si256(); // OR of all results, sign bit set if any negative
+    int j = 0;
+    for (; j + 8 <= colCount; j += 8) {
+        __m256i diff = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(first+j)),_mm256_loadu_si256((const __m256i*)(second+j)));
+        _mm256_storeu_si256((__m256i*)(result+j),diff);
+        signs = _mm256_or_si256(signs,diff);
+    }
+    _mm256_zeroupper();
+    return (_mm256_movemask_ps(_mm256_castsi256_ps(signs)) != 0) | rowSubtractSse2(result+j,first+j,second+j,colCount-j);
+}
+static __attribute__((target("avx2"))) int rowFits16Avx2(const short *need, const short *available, int colCount) {
+    int j = 0;
+    for (; j + 16 <= colCount; j += 16) {
+        __m256i exceeds = _mm256_cmpgt_epi16(_mm256_loadu_si256((const __m256i*)(need+j)),_mm256_loadu_si256((const __m256i*)(available+j)));
+        if (_mm256_movemask_epi8(exceeds)) { return 0; }
+    }
+    _mm256_zeroupper();
+    return rowFits16Sse2(need+j,available+j,colCount-j);
+}
+static __attribute__((target("avx2"))) void rowAdd16Avx2(short *available, const short *row, int colCount) {
+    int j = 0;
+    for (; j + 16 <= colCount; j += 16) {
+        __m256i sum = _mm256_add_epi16(_mm256_loadu_si256((const __m256i*)(available+j)),_mm256_loadu_si256((const __m256i*)(row+j)));
+        _mm256_storeu_si256((__m256i*)(available+j),sum);
+    }
+    _mm256_zeroupper();
+    rowAdd16Sse2(available+j,row+j,colCount-j);
+}
+#endif
+// Width kernels, one set per resource count in FIXED_WIDTHS. N is a constant in each, so loops unroll and the available vector (and per-column
+//     counts/cursors) live in locals for a whole row share instead of being re-read per row. Plain C, the compiler picks the instructions
+#define DEFINE_WIDTH_KERNELS(N) \
+static void countRows##N(int *const *need, const int *available, int *colCounts, int *pendingRes, int first, int last) { \
+    int avail[N]; \
+    int counts[N]; \
+    FIXED_UNROLL for (int j = 0; j < N; ++j) { avail[j] = available[j]; counts[j] = 0; } \
+    for (int i = first; i < last; ++i) { \
+        const int *row = need[i]; \
+        int count = 0; \
+        FIXED_UNROLL for (int j = 0; j < N; ++j) { int exceeds = (row[j] > avail[j]); counts[j] += exceeds; count += exceeds; } \
+        pendingRes[i] = count; \
+    } \
+    FIXED_UNROLL for (int j = 0; j < N; ++j) { colCounts[j] += counts[j]; } \
+} \
+static void fillRows##N(int *const *need, const int *available, const int *pendingRes, long long *thresholds, int *cursors, int first, int last) { \
+    int avail[N]; \
+    int cursor[N]; \
+    FIXED_UNROLL for (int j = 0; j < N; ++j) { avail[j] = available[j]; cursor[j] = cursors[j]; } \
+    for (int i = first; i < last; ++i) { \
+        if (pendingRes[i] == 0) { continue; } \
+        const int *row = need[i]; \
+        FIXED_UNROLL for (int j = 0; j < N; ++j) { if (row[j] > avail[j]) { thresholds[cursor[j]++] = ((long long)row[j] << 32) | i; } } \
+    } \
+    FIXED_UNROLL for (int j = 0; j < N; ++j) { cursors[j] = cursor[j]; } \
+} \
+static int walkPrefix##N(int *const *need, int *const *alloc, const int *order, int count, const int *available) { \
+    int work[N]; \
+    FIXED_UNROLL for (int j = 0; j < N; ++j) { work[j] = available[j]; } \
+    for (int i = 0; i < count; ++i) { \
+        const int *row = need[order[i]]; \
+        int exceeds = 0; \
+        FIXED_UNROLL for (int j = 0; j < N; ++j) { exceeds |= (row[j] > work[j]); } \
+        if (exceeds) { return i; } \
+        const int *held = alloc[order[i]]; \
+        FIXED_UNROLL for (int j = 0; j < N; ++j) { work[j] += held[j]; } \
+    } \
+    return count; \
+} \
+static void rowAdd##N(int *available, const int *row) { \
+    FIXED_UNROLL for (int j = 0; j < N; ++j) { available[j] += row[j]; } \
+} \
+static int rowSubtract##N(int *result, const int *first, const int *second) { \
+    int negative = 0; \
+    FIXED_UNROLL for (int j = 0; j < N; ++j) { result[j] = first[j] - second[j]; negative |= result[j]; } \
+    return negative < 0; \
+}
+FIXED_WIDTHS(DEFINE_WIDTH_KERNELS)
+#define WIDTH_KERNELS_ENTRY(N) {countRows##N,fillRows##N,walkPrefix##N,rowAdd##N,rowSubtract##N},
+static const widthKernels WIDTH_KERNELS[FIXED_MAX_COLS] = { FIXED_WIDTHS(WIDTH_KERNELS_ENTRY) }; // Entry N-1 is width N
+static const widthKernels *widthKernelsFor(const bankerState *state, int colCount) { // Dispatch from loaded (or viewed) resource count, anything wider uses ROW_KERNELS
+    if (colCount < 1 || colCount > FIXED_MAX_COLS || (state->flags & BANKER_GENERIC_WIDTH)) { return NULL; }
+    return &WIDTH_KERNELS[colCount-1];
+}
+static int selectRowKernels(const char *name) { // Fills ROW_KERNELS, 'auto' uses widest instruction set the cpu reports
+    rowKernels scalarSet = {"scalar",rowFitsScalar,rowCountExceedsScalar,rowAddScalar,rowSubtractScalar,rowFits16Scalar,rowAdd16Scalar};
+    ROW_KERNELS = scalarSet; // Fallback, always valid
+    int wantAuto = (strcmp(name,"auto") == 0);
+#if HAVE_X86_KERNELS
+    __builtin_cpu_init();
+    int hasSse2 = __builtin_cpu_supports("sse2");
+    int hasAvx2 = __builtin_cpu_supports("avx2");
+    if ((wantAuto && hasAvx2) || strcmp(name,"avx2") == 0) {
+        if (!hasAvx2) { return 1; }
+        rowKernels avx2Set = {"avx2",rowFitsAvx2,rowCountExceedsAvx2,rowAddAvx2,rowSubtractAvx2,rowFits16Avx2,rowAdd16Avx2};
+        ROW_KERNELS = avx2Set;
+        return 0;
+    }
+    if ((wantAuto && hasSse2) || strcmp(name,"sse2") == 0) {
+        if (!hasSse2) { return 1; }
+        rowKernels sse2Set = {"sse2",rowFitsSse2,rowCountExceedsSse2,rowAddSse2,rowSubtractSse2,rowFits16Sse2,rowAdd16Sse2};
+        ROW_KERNELS = sse2Set;
+        return 0;
+    }
+#endif
+    return !(wantAuto || strcmp(name,"scalar") == 0); // Scalar, or unknown name
+}
+static void narrowRow(short *shortRow, const int *intRow, int colCount) { // Caller ensures every value fits in 16 bits
+    for (int j = 0; j < colCount; ++j) { shortRow[j] = (short)intRow[j]; }
+}
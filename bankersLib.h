@@ -0,0 +1,100 @@
+///// Alex Tregub
+///// CS33211-001
+///// Banker's Algorithm library (safety checks, requests, releases) used by bankersAlgo
+///// ===========
+///// v1.19.2
+///// Every system state is one opaque bankerState, owning its matrices and all
+/////     scratch space in a single arena allocation made by bankerCreate. Loads,
+/////     checks, requests, releases and copies never allocate, so a state can be
+/////     checked in a scheduler's hot path. States are independent (one thread per
+/////     state), only bankerSelectKernels is process-wide. bankerWhatIf and
+/////     bankerHeadroom only read the state (several threads may query one state), so
+/////     their scratch is a workspace given by the caller, sized once by
+/////     bankerWhatIfWorkspace/bankerHeadroomWorkspace and reused for every call.
+///// Sparse states (bankerCreateSparse) keep only non-zero need/alloc values, so
+/////     memory and check time follow the non-zero count instead of rows*cols.
+///// - Build via > ./buildScript.sh (libbankers.a, libbankers.so, ./bankersAlgo and ./bankersDaemon)
+///// - Link via > gcc -pthread yourProgram.c libbankers.a (or -L. -lbankers)
+///// ===========
+#ifndef BANKERS_LIB_H
+#define BANKERS_LIB_H
+
+#include <stddef.h>
+
+#define BANKER_OK 0 // Results of load/request/release/add calls
+#define BANKER_DENY_MAXIMUM 1 // Request exceeds remaining need (maximum claim)
+#define BANKER_DENY_AVAILABLE 2 // Request exceeds available, process must wait
+#define BANKER_DENY_UNSAFE 3 // Granting would leave no safe sequence (state unchanged)
+#define BANKER_DENY_ALLOCATED 4 // Release exceeds what the process holds
+#define BANKER_DENY_TOTAL 5 // Added process claims more than the system has
+#define BANKER_INVALID -1 // Bad size, process index or value (negative, or allocated above maximum)
+#define BANKER_FULL -2 // No row (or sparse entry) capacity left, copy into a larger state
+
+#define BANKER_LOWEST_FIRST 1 // Flags: queue lowest index ready process first (original rescan sequence)
+#define BANKER_ROUNDS 2 // Flags: sequence built in rounds (ascending index per round), same for any thread count
+#define BANKER_NARROW 4 // Flags: keep 16-bit copies of need/alloc for request re-checks (used when all values fit)
+#define BANKER_VIEW_ONLY 8 // Flags: state without matrices, only lends scratch to bankerCheckView (loads and added processes return BANKER_INVALID, row ptr accessors NULL)
+#define BANKER_PRIORITY 16 // Flags: ready process with smallest key (bankerSetPriorities) queued first, ties by lowest index. Overrides BANKER_LOWEST_FIRST/BANKER_ROUNDS
+#define BANKER_GENERIC_WIDTH 32 // Flags: skip the kernels generated for 1..16 resources, generic row loops only (baseline for benchmarks)
+#define BANKER_MAX_THREADS 256 // Upper limit for bankerSetThreads
+#define BANKER_WIDTH_KERNEL_MAX 16 // Dense states of 1..this many resources use kernels generated for their exact width (unless BANKER_GENERIC_WIDTH)
+#define BANKER_SPARSE_DENSITY 8 // Suggested switch: sparse state when at most 1 in this many allocated/maximum values is non-zero (below this, sparse checks win, above, dense parsing does)
+#define BANKER_SPARSE_MIN_VALUES (1<<16) // Suggested switch: states of fewer rows*cols values stay dense (dense kernels win when small)
+#ifndef BANKER_STATS
+#define BANKER_STATS 1 // Work counters (bankerGetCounters) and CLI --stats, build everything with -DBANKER_STATS=0 to compile them out
+#endif
+
+typedef struct bankerState bankerState; // Opaque, see bankersLib.c
+typedef struct bankerCounters { // Work done by checks and requests of one state (bankerGetCounters)
+    long long checks; // Full safety checks (bankerCheck, bankerCheckView, request re-sequencing)
+    long long rowCompares; // Need rows compared against an available vector (check count phase, request prefix re-checks)
+    long long earlyExits; // Compared rows that did not fit (need > available on some resource)
+    long long needWakes; // Unsatisfied (process,resource) needs later met by released resources
+} bankerCounters;
+
+bankerState *bankerCreate(int,int,int); // One arena allocation for up to rows x cols. Params: rowCapacity,colCapacity,flags. Returns state (NULL if alloc failed or size invalid)
+bankerState *bankerCreateSparse(int,int,int,int); // As bankerCreate, but need/alloc stored as entries (one per non-zero maximum value, ascending resource per process). Row ptr accessors return NULL, BANKER_NARROW ignored, checks run on the calling thread. Params: rowCapacity,colCapacity,entryCapacity,flags
+void bankerDestroy(bankerState*); // Frees arena. Takes: state (NULL ok)
+bankerState *bankerClone(const bankerState*); // New state with same capacity, flags and contents. Takes: state. Returns clone (NULL if alloc failed)
+int bankerCopy(bankerState*,const bankerState*); // Copies contents (and sequence) without allocating, target capacity must fit (same storage, dense or sparse). Params: target,source. Returns BANKER_OK or BANKER_INVALID
+int bankerSetThreads(bankerState*,int); // Threads for checks of this state (1 = calling thread only, no thread creation). Params: state,threads. Returns BANKER_OK or BANKER_INVALID
+int bankerSelectKernels(const char*); // Process-wide row kernels: auto, scalar, sse2, avx2 (call before states are used from several threads). Takes: name. Returns 0 if success, 1 if unknown/unsupported
+const char *bankerKernelName(void); // Returns active row kernel set name
+
+int bankerLoad(bankerState*,int,int,const int*,const int*,const int*,int); // Copies row-major matrices into state, then as bankerEndLoad. Params: state,rows,cols,allocated,maximum,available,rowStride(ints per row). Returns BANKER_OK or BANKER_INVALID
+int bankerBeginLoad(bankerState*,int,int); // Sizes state for filling in place through bankerAllocRows/bankerMaxRows/bankerAvailable (dense), or the row loaders below. Params: state,rows,cols. Returns BANKER_OK or BANKER_INVALID (exceeds capacity)
+int bankerLoadAllocRow(bankerState*,int,const int*); // Loads allocated row of process, processes in order 0..rows-1 (dense or sparse). Params: state,process,row(cols). Returns BANKER_OK, BANKER_FULL (sparse entries) or BANKER_INVALID (out of order)
+int bankerLoadMaxRow(bankerState*,int,const int*); // Loads maximum row of process, after every allocated row, in order. Params: state,process,row(cols). Returns BANKER_OK, BANKER_FULL or BANKER_INVALID
+int bankerEndLoad(bankerState*); // Computes need (dense), totals and 16-bit copies after filling, forgets old sequence. Takes: state. Returns BANKER_OK or BANKER_INVALID (negative, or allocated above maximum)
+int bankerSetPriorities(bankerState*,const int*); // Ready keys of loaded processes for BANKER_PRIORITY checks (added processes get 0), used from the next check on. Params: state,keys(rows, NULL for total remaining need of each process, shortest need first). Returns BANKER_OK or BANKER_INVALID (state created without BANKER_PRIORITY)
+int **bankerAllocRows(bankerState*); // Row ptrs (rows x cols used), NULL for sparse states. Takes: state
+int **bankerMaxRows(bankerState*);
+int **bankerNeedRows(bankerState*);
+int *bankerAvailable(bankerState*);
+
+int bankerCheck(bankerState*); // Full safety check of loaded state, sequence in bankerOrder. Takes: state. Returns processes queued (rows if safe)
+int bankerCheckView(bankerState*,int,int,const int*,const int*,const int*,int); // Safety check of matrices owned elsewhere (eg. mapped file), state only lends scratch and receives sequence. Params: state,rows,cols,allocated,needed,available,rowStride. Returns processes queued (BANKER_INVALID if exceeds capacity, or state is sparse)
+int bankerRequest(bankerState*,int,const int*); // Resource-request algorithm, only the sequence prefix before proc is re-checked when known safe. Params: state,process,request(cols). Returns BANKER_OK (granted) or BANKER_DENY_*/BANKER_INVALID (state unchanged)
+int bankerRelease(bankerState*,int,const int*); // Returns resources, known safe sequence stays safe. Params: state,process,release(cols). Returns BANKER_OK, BANKER_DENY_ALLOCATED or BANKER_INVALID
+int bankerAddProcess(bankerState*,const int*); // Appends process (index rows) with zero allocation, queued last. Params: state,maximum(cols). Returns BANKER_OK, BANKER_DENY_TOTAL, BANKER_FULL or BANKER_INVALID
+int bankerWhatIf(const bankerState*,int,const int*,const int*,int,unsigned char*,int*,int*,void*,size_t); // Evaluates each candidate request on its own against the checked state (state unchanged). Params: state,count,procs,requests(candidate i at i*stride),requestStride,outputGrantBits((count+7)/8 bytes, bit i set if granted, NULL ok),outputResults(BANKER_* per candidate, NULL ok),outputProven(NULL ok),workspace,workspaceBytes. Returns candidates granted, BANKER_INVALID if workspace is smaller than bankerWhatIfWorkspace
+size_t bankerWhatIfWorkspace(const bankerState*,int); // Workspace bytes for bankerWhatIf of count candidates, from capacities and threads of state (size again after bankerSetThreads raises threads). Params: state,count. Returns bytes
+int bankerHeadroom(const bankerState*,int,int*,void*,size_t); // Maximum safe grant of each resource on its own for checked state (state unchanged), 0 where none. One process costs a few guided re-checks per resource, all processes one closure sweep per resource (O(cols * (rows log rows + needs above available))). Params: state,process(-1 for all),outputHeadroom(cols, or rows*cols row-major),workspace,workspaceBytes. Returns BANKER_OK, BANKER_DENY_UNSAFE (state unsafe, all 0) or BANKER_INVALID (bad process, or workspace smaller than bankerHeadroomWorkspace)
+size_t bankerHeadroomWorkspace(const bankerState*,int); // Workspace bytes for bankerHeadroom, as bankerWhatIfWorkspace: O(rows + cols) for one process. For all, one key per possible need above available plus O(rows + cols) per thread (dense, one prefix column at a time) or 2 ints per entry per thread (sparse). Params: state,process(-1 for all). Returns bytes
+
+int bankerRows(const bankerState*); // Loaded processes
+int bankerCols(const bankerState*); // Loaded resources
+int bankerRowCapacity(const bankerState*);
+int bankerColCapacity(const bankerState*);
+int bankerFlags(const bankerState*);
+int bankerIsSafe(const bankerState*); // 1 if bankerOrder holds a full safe sequence for the current state
+int bankerQueued(const bankerState*); // Processes in bankerOrder (rows if safe, fewer after an unsafe check)
+const int *bankerOrder(const bankerState*); // Sequence of last check (kept up to date by requests/releases/adds while safe)
+unsigned int bankerOrderVersion(const bankerState*); // Changes whenever bankerOrder/bankerQueued change (checks, loads, re-sequencing requests, adds), so callers can keep copies
+const int *bankerFinalAvailable(const bankerState*); // Available once every queued process of last check finished
+int bankerUsesNarrow(const bankerState*); // 1 if request re-checks use 16-bit copies
+int bankerIsSparse(const bankerState*); // 1 if created by bankerCreateSparse
+int bankerEntries(const bankerState*); // Sparse entries in use (0 for dense states)
+void bankerGetCounters(const bankerState*,bankerCounters*); // Counters since bankerCreate (all 0 when built with BANKER_STATS=0). Params: state,outputCounters
+
+#endif
@@ -0,0 +1,304 @@
+///// Alex Tregub
+///// CS33211-001
+///// Banker's Algorithm daemon load generator
+///// ===========
+///// v1.16.0
+///// Opens one connection per client thread to a running bankersDaemon and
+/////     sends a read/write mix for a fixed time, one frame in flight per
+/////     client. Writes request 1 unit of a random resource for a random
+/////     process, and a granted request is released again by that client's
+/////     next write, so the state stays near where it started. Reports
+/////     throughput and p50/p99/p99.9 latency for each op. With -m, headroom
+/////     replies are checked against bankersAlgo -m output for the same input
+/////     (replies after a granted change have a later epoch and are skipped,
+/////     so use -q 100 to check every one).
+///// - Compile via > ./buildBenchScript.sh
+///// - Run via > ./bankersLoad [options] SOCKET
+/////     - Option -c N : client threads, each with its own connection (default 8)
+/////     - Option -t SECONDS : run time (default 5)
+/////     - Option -q PERCENT : read-only ops (query/headroom/available) in the mix (default 90)
+/////     - Option -s PERCENT : reads that fetch the full safe sequence (query) (default 50)
+/////     - Option -h PERCENT : reads that fetch headroom of a random process, the rest fetch the available vector (default 25)
+/////     - Option -m FILE : expected headroom, output of > ./bankersAlgo -m all -o sequence INPUT (INPUT as loaded by daemon)
+/////     - Option -S SEED : random seed (default 1)
+///// ===========
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "bankersProto.h"
+
+#define LOAD_MAX_CLIENTS 1024 // Upper limit for -c
+#define LOAD_GRANTED 0 // BANKER_OK in daemon replies
+
+typedef struct latencyList { // Reply latencies of one op, in ns (grown by doubling)
+    long long *values;
+    long count;
+    long capacity;
+} latencyList;
+
+typedef struct clientRun { // One client thread: its settings in, its latencies and counts out
+    int index;
+    uint64_t seed;
+    latencyList latencies[PROTO_OP_COUNT];
+    long granted; // Requests answered BANKER_OK
+    long failed; // 1 if connection or a reply failed (client stopped early)
+    long headroomChecked; // Headroom replies compared with EXPECTED_HEADROOM
+    long headroomMismatched;
+    long headroomSkipped; // Replies from a later epoch than START_EPOCH
+} clientRun;
+
+const char *SOCKET_PATH = NULL;
+int ROW_COUNT = 0; // From PROTO_INFO before clients start
+int COL_COUNT = 0;
+int READ_PERCENT = 90;
+int QUERY_PERCENT = 50;
+int HEADROOM_PERCENT = 25;
+int32_t *EXPECTED_HEADROOM = NULL; // ROW_COUNT x COL_COUNT from -m, NULL if not checking
+uint32_t START_EPOCH = 0; // Epoch EXPECTED_HEADROOM belongs to
+double STOP_TIME = 0; // nowSeconds value clients stop at
+
+void *runClient(void*); // Client thread: connects and sends op mix until STOP_TIME. Takes: clientRun. Returns NULL
+int32_t *loadExpectedHeadroom(const char*); // Reads ROW_COUNT x COL_COUNT values (bankersAlgo -m all -o sequence). Takes: path. Returns matrix (NULL if unreadable or short)
+int exchangeFrame(int,protoHeader*,const int32_t*,int32_t*,uint32_t); // Sends request frame, waits for reply (header overwritten with reply). Params: fd,header,payload,replyPayload,replyCapacity(bytes). Returns FRAME_*
+int addLatency(latencyList*,long long); // Params: list,latency. Returns 0 if success, 1 if alloc failed
+int compareLatency(const void*,const void*); // qsort order for long long
+void printLatencyLine(const char*,latencyList*,double); // Sorts list, prints count, rate and percentiles. Params: opName,list,seconds
+uint64_t nextRandom(uint64_t*); // splitmix64 step. Takes: rngState (updated). Returns 64 random bits
+double nowSeconds(void); // Monotonic clock in seconds
+
+
+
+int main(int argc, char *argv[]) {
+    //// Parse options, socket is the last non-option argument
+    int clientCount = 8;
+    double seconds = 5;
+    uint64_t seed = 1;
+    const char *expectedPath = NULL;
+    for (int i = 1; i < argc; ++i) {
+        int hasValue = (i+1 < argc);
+        if (strcmp(argv[i],"-c") == 0 && hasValue) { clientCount = atoi(argv[++i]); }
+        else if (strcmp(argv[i],"-t") == 0 && hasValue) { seconds = atof(argv[++i]); }
+        else if (strcmp(argv[i],"-q") == 0 && hasValue) { READ_PERCENT = atoi(argv[++i]); }
+        else if (strcmp(argv[i],"-s") == 0 && hasValue) { QUERY_PERCENT = atoi(argv[++i]); }
+        else if (strcmp(argv[i],"-h") == 0 && hasValue) { HEADROOM_PERCENT = atoi(argv[++i]); }
+        else if (strcmp(argv[i],"-m") == 0 && hasValue) { expectedPath = argv[++i]; }
+        else if (strcmp(argv[i],"-S") == 0 && hasValue) { seed = strtoull(argv[++i],NULL,10); }
+        else if (argv[i][0] == '-') { printf("ERROR : Unknown option (%s).\n",argv[i]); return 1; }
+        else { SOCKET_PATH = argv[i]; }
+    }
+    if (SOCKET_PATH == NULL) { printf("ERROR : Daemon socket path needed.\n"); return 1; }
+    if (clientCount < 1 || clientCount > LOAD_MAX_CLIENTS) { printf("ERROR : Client count must be 1 to %d.\n",LOAD_MAX_CLIENTS); return 1; }
+    if (seconds <= 0) { printf("ERROR : Run time must be above 0 seconds.\n"); return 1; }
+    if (READ_PERCENT < 0 || READ_PERCENT > 100 || QUERY_PERCENT < 0 || HEADROOM_PERCENT < 0 || QUERY_PERCENT + HEADROOM_PERCENT > 100) {
+        printf("ERROR : Percentages must be 0 to 100 (query and headroom together at most 100).\n");
+        return 1;
+    }
+
+    //// Ask daemon for state size, so clients pick valid processes/resources
+    int fd = connectSocket(SOCKET_PATH);
+    protoHeader header = {0,PROTO_INFO,0,0,0};
+    int32_t info[4];
+    if (fd == -1 || exchangeFrame(fd,&header,NULL,info,sizeof(info)) != FRAME_OK || header.length != sizeof(info)) {
+        printf("ERROR : No daemon answering on (%s).\n",SOCKET_PATH);
+        if (fd != -1) { close(fd); }
+        return 1;
+    }
+    close(fd);
+    ROW_COUNT = info[1];
+    COL_COUNT = info[2];
+    START_EPOCH = header.epoch;
+    printf("INFO : Daemon protocol %d, %d processes x %d resources, %s, epoch %u.\n",info[0],ROW_COUNT,COL_COUNT,info[3] ? "safe" : "not safe",START_EPOCH);
+    if (info[0] < PROTO_VERSION && HEADROOM_PERCENT > 0 && READ_PERCENT > 0) { printf("ERROR : Daemon protocol %d has no headroom op, %d needed.\n",info[0],PROTO_VERSION); return 1; }
+    if (expectedPath != NULL && (EXPECTED_HEADROOM = loadExpectedHeadroom(expectedPath)) == NULL) {
+        printf("ERROR : Unable to read %d x %d expected headroom values from (%s).\n",ROW_COUNT,COL_COUNT,expectedPath);
+        return 1;
+    }
+    printf("INFO : %d client(s) for %.1f s, %d%% reads (%d%% of them query, %d%% headroom).\n",clientCount,seconds,READ_PERCENT,QUERY_PERCENT,HEADROOM_PERCENT);
+    fflush(stdout);
+
+    //// Run clients
+    clientRun *runs = (clientRun*)calloc((size_t)clientCount,sizeof(clientRun));
+    pthread_t *threads = (pthread_t*)malloc(sizeof(pthread_t)*(size_t)clientCount);
+    if (runs == NULL || threads == NULL) { printf("ERROR : Unable to allocate clients.\n"); return 1; }
+    double startTime = nowSeconds();
+    STOP_TIME = startTime + seconds;
+    int started = 0;
+    for (int c = 0; c < clientCount; ++c) {
+        runs[c].index = c;
+        runs[c].seed = seed + 0x9E3779B97F4A7C15ULL*(uint64_t)(c+1);
+        if (pthread_create(&threads[c],NULL,runClient,&runs[c]) != 0) { break; }
+        ++started;
+    }
+    for (int c = 0; c < started; ++c) { pthread_join(threads[c],NULL); }
+    double elapsed = nowSeconds() - startTime;
+
+    //// Merge per-client latencies per op, then report
+    latencyList merged[PROTO_OP_COUNT];
+    latencyList all = {NULL,0,0};
+    long granted = 0;
+    long failedClients = 0;
+    long headroomChecked = 0, headroomMismatched = 0, headroomSkipped = 0;
+    memset(merged,0,sizeof(merged));
+    for (int c = 0; c < started; ++c) {
+        granted += runs[c].granted;
+        failedClients += runs[c].failed;
+        headroomChecked += runs[c].headroomChecked;
+        headroomMismatched += runs[c].headroomMismatched;
+        headroomSkipped += runs[c].headroomSkipped;
+        for (int op = 1; op < PROTO_OP_COUNT; ++op) {
+            latencyList *source = &runs[c].latencies[op];
+            for (long i = 0; i < source->count; ++i) {
+                if (addLatency(&merged[op],source->values[i]) || addLatency(&all,source->values[i])) { printf("ERROR : Unable to allocate latency lists.\n"); return 1; }
+            }
+            free(source->values);
+        }
+    }
+    if (failedClients > 0) { printf("INFO : %ld client(s) lost their connection early.\n",failedClients); }
+    printf("OUTPUT : %ld ops in %.2f s (%.0f ops/s) from %d client(s), %ld request(s) granted.\n",all.count,elapsed,all.count/elapsed,started,granted);
+    printLatencyLine("request",&merged[PROTO_REQUEST],elapsed);
+    printLatencyLine("release",&merged[PROTO_RELEASE],elapsed);
+    printLatencyLine("query",&merged[PROTO_QUERY],elapsed);
+    printLatencyLine("headroom",&merged[PROTO_HEADROOM],elapsed);
+    printLatencyLine("available",&merged[PROTO_AVAILABLE],elapsed);
+    printLatencyLine("all",&all,elapsed);
+    if (EXPECTED_HEADROOM != NULL) {
+        printf("OUTPUT : Headroom check: %ld repl%s compared, %ld mismatched, %ld skipped (later epoch).\n",headroomChecked,headroomChecked == 1 ? "y" : "ies",headroomMismatched,headroomSkipped);
+    }
+    for (int op = 0; op < PROTO_OP_COUNT; ++op) { free(merged[op].values); }
+    free(all.values);
+    free(runs);
+    free(threads);
+    free(EXPECTED_HEADROOM);
+    return (headroomMismatched > 0) ? 1 : 0;
+}
+
+
+
+//// Function definitions
+void *runClient(void *arg) {
+    clientRun *run = (clientRun*)arg;
+    uint64_t rng = run->seed;
+    int fd = connectSocket(SOCKET_PATH);
+    uint32_t replyCapacity = sizeof(int32_t)*(uint32_t)(ROW_COUNT > COL_COUNT ? ROW_COUNT : COL_COUNT); // Sequence or one vector, larger replies are skipped
+    int32_t *request = (int32_t*)calloc((size_t)COL_COUNT,sizeof(int32_t));
+    int32_t *reply = (int32_t*)malloc(replyCapacity);
+    int heldProcess = -1; // Process holding the unit granted by last request, -1 if none
+    int heldResource = 0;
+    if (fd == -1 || request == NULL || reply == NULL) { run->failed = 1; }
+    while (!run->failed && nowSeconds() < STOP_TIME) {
+        protoHeader header = {0,0,0,0,0};
+        int isRead = (int)(nextRandom(&rng) % 100) < READ_PERCENT;
+        if (isRead) {
+            int pick = (int)(nextRandom(&rng) % 100);
+            header.op = (pick < QUERY_PERCENT) ? PROTO_QUERY : (pick < QUERY_PERCENT + HEADROOM_PERCENT) ? PROTO_HEADROOM : PROTO_AVAILABLE;
+            if (header.op == PROTO_HEADROOM) { header.process = (int32_t)(nextRandom(&rng) % (uint64_t)ROW_COUNT); }
+        } else if (heldProcess != -1) { // Give back last grant
+            header.op = PROTO_RELEASE;
+            header.process = heldProcess;
+            request[heldResource] = 1;
+        } else {
+            header.op = PROTO_REQUEST;
+            header.process = (int32_t)(nextRandom(&rng) % (uint64_t)ROW_COUNT);
+            heldResource = (int)(nextRandom(&rng) % (uint64_t)COL_COUNT);
+            request[heldResource] = 1;
+        }
+        header.length = isRead ? 0 : sizeof(int32_t)*(uint32_t)COL_COUNT;
+        int op = header.op;
+        int32_t process = header.process;
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC,&start);
+        int result = exchangeFrame(fd,&header,request,reply,replyCapacity);
+        clock_gettime(CLOCK_MONOTONIC,&end);
+        if (result == FRAME_CLOSED || header.status == PROTO_BAD_FRAME) {
+            run->failed = 1;
+            break;
+        }
+        if (!isRead) { request[heldResource] = 0; }
+        if (op == PROTO_REQUEST && header.status == LOAD_GRANTED) {
+            heldProcess = process;
+            ++run->granted;
+        } else if (op == PROTO_RELEASE) {
+            heldProcess = -1;
+        } else if (op == PROTO_HEADROOM && EXPECTED_HEADROOM != NULL) {
+            if (header.epoch != START_EPOCH) { ++run->headroomSkipped; }
+            else {
+                const int32_t *expected = &EXPECTED_HEADROOM[(size_t)process*(size_t)COL_COUNT];
+                ++run->headroomChecked;
+                if (result != FRAME_OK || header.length != sizeof(int32_t)*(uint32_t)COL_COUNT || memcmp(reply,expected,header.length) != 0) {
+                    if (run->headroomMismatched++ == 0) { printf("ERROR : Headroom of process %d (status %d) differs from expected.\n",process,header.status); }
+                }
+            }
+        }
+        long long latency = (long long)(end.tv_sec - start.tv_sec)*1000000000LL + (end.tv_nsec - start.tv_nsec);
+        if (addLatency(&run->latencies[op],latency)) { run->failed = 1; }
+    }
+    if (heldProcess != -1 && !run->failed) { // Leave state as found
+        protoHeader header = {sizeof(int32_t)*(uint32_t)COL_COUNT,PROTO_RELEASE,0,heldProcess,0};
+        request[heldResource] = 1;
+        exchangeFrame(fd,&header,request,reply,replyCapacity);
+    }
+    if (fd != -1) { close(fd); }
+    free(request);
+    free(reply);
+    return NULL;
+}
+int32_t *loadExpectedHeadroom(const char *path) {
+    FILE *file = fopen(path,"r");
+    if (file == NULL) { return NULL; }
+    size_t count = (size_t)ROW_COUNT*(size_t)COL_COUNT;
+    int32_t *values = (int32_t*)malloc(sizeof(int32_t)*(count > 0 ? count : 1));
+    for (size_t i = 0; values != NULL && i < count; ++i) {
+        if (fscanf(file,"%d",&values[i]) != 1) {
+            free(values);
+            values = NULL;
+        }
+    }
+    fclose(file);
+    return values;
+}
+int exchangeFrame(int fd, protoHeader *header, const int32_t *payload, int32_t *replyPayload, uint32_t replyCapacity) {
+    if (sendFrame(fd,header,payload) != FRAME_OK) { return FRAME_CLOSED; }
+    return readFrame(fd,header,replyPayload,replyCapacity);
+}
+int addLatency(latencyList *list, long long value) {
+    if (list->count == list->capacity) {
+        long capacity = (list->capacity > 0) ? 2*list->capacity : 4096;
+        long long *grown = (long long*)realloc(list->values,sizeof(long long)*(size_t)capacity);
+        if (grown == NULL) { return 1; }
+        list->values = grown;
+        list->capacity = capacity;
+    }
+    list->values[list->count++] = value;
+    return 0;
+}
+int compareLatency(const void *a, const void *b) {
+    long long left = *(const long long*)a;
+    long long right = *(const long long*)b;
+    return (left > right) - (left < right);
+}
+void printLatencyLine(const char *opName, latencyList *list, double seconds) {
+    if (list->count == 0) {
+        printf("OUTPUT : %-9s      0 ops\n",opName);
+        return;
+    }
+    qsort(list->values,(size_t)list->count,sizeof(long long),compareLatency);
+    long last = list->count - 1;
+    printf("OUTPUT : %-9s %9ld ops %10.0f ops/s  p50 %7.1f us  p99 %7.1f us  p99.9 %7.1f us  max %8.1f us\n",opName,list->count,list->count/seconds,
+        list->values[last*50/100]/1000.0,list->values[last*99/100]/1000.0,list->values[last*999/1000]/1000.0,list->values[last]/1000.0);
+}
+uint64_t nextRandom(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+double nowSeconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC,&now);
+    return now.tv_sec + now.tv_nsec*1e-9;
+}
@@ -0,0 +1,79 @@
+///// Alex Tregub
+///// CS33211-001
+///// Banker's Algorithm daemon protocol, see bankersProto.h
+///// ===========
+///// v1.14.0
+///// - Blocking frame reads/writes over stream sockets
+///// ===========
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include "bankersProto.h"
+
+static int readAll(int,void*,size_t); // Reads exactly bytes (retries short reads). Params: fd,buffer,bytes. Returns 0 if success, 1 if closed/failed
+
+
+
+int readFrame(int fd, protoHeader *header, int32_t *payload, uint32_t capacity) {
+    if (readAll(fd,header,sizeof(protoHeader))) { return FRAME_CLOSED; }
+    if (header->length <= capacity) { return readAll(fd,payload,header->length) ? FRAME_CLOSED : FRAME_OK; }
+    char discard[4096]; // Oversized payload skipped so the next frame still starts on a header
+    uint32_t left = header->length;
+    while (left > 0) {
+        uint32_t chunk = (left < sizeof(discard)) ? left : (uint32_t)sizeof(discard);
+        if (readAll(fd,discard,chunk)) { return FRAME_CLOSED; }
+        left -= chunk;
+    }
+    return FRAME_TOO_LARGE;
+}
+int sendFrame(int fd, const protoHeader *header, const int32_t *payload) {
+    struct iovec parts[2] = {{(void*)header,sizeof(protoHeader)},{(void*)payload,header->length}};
+    struct msghdr message;
+    memset(&message,0,sizeof(message));
+    message.msg_iov = parts;
+    message.msg_iovlen = (header->length > 0) ? 2 : 1;
+    while (message.msg_iovlen > 0) {
+        ssize_t sent = sendmsg(fd,&message,MSG_NOSIGNAL); // EPIPE instead of SIGPIPE when peer is gone
+        if (sent == -1 && errno == EINTR) { continue; }
+        if (sent <= 0) { return FRAME_CLOSED; }
+        while (message.msg_iovlen > 0 && (size_t)sent >= message.msg_iov[0].iov_len) { // Drop fully sent parts
+            sent -= (ssize_t)message.msg_iov[0].iov_len;
+            ++message.msg_iov;
+            --message.msg_iovlen;
+        }
+        if (message.msg_iovlen > 0) { // Partly sent part
+            message.msg_iov[0].iov_base = (char*)message.msg_iov[0].iov_base + sent;
+            message.msg_iov[0].iov_len -= (size_t)sent;
+        }
+    }
+    return FRAME_OK;
+}
+int connectSocket(const char *path) {
+    struct sockaddr_un address;
+    memset(&address,0,sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) { return -1; }
+    strcpy(address.sun_path,path);
+    int fd = socket(AF_UNIX,SOCK_STREAM,0);
+    if (fd == -1) { return -1; }
+    if (connect(fd,(struct sockaddr*)&address,sizeof(address)) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+static int readAll(int fd, void *buffer, size_t bytes) {
+    char *next = (char*)buffer;
+    while (bytes > 0) {
+        ssize_t got = read(fd,next,bytes);
+        if (got == -1 && errno == EINTR) { continue; }
+        if (got <= 0) { return 1; }
+        next += got;
+        bytes -= (size_t)got;
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+///// Alex Tregub
+///// CS33211-001
+///// Banker's Algorithm daemon protocol (frames shared by bankersDaemon and bankersLoad)
+///// ===========
+///// v1.16.0
+///// Every message is one frame: a 16 byte protoHeader, then 'length' bytes of
+/////     int32 payload. Frames use host byte order (Unix domain sockets only, so
+/////     both ends are on one machine). Each request frame gets exactly one reply
+/////     frame, in order, so a client may pipeline several requests.
+///// - Compiled into ./bankersDaemon (buildScript.sh) and ./bankersLoad (buildBenchScript.sh)
+///// ===========
+#ifndef BANKERS_PROTO_H
+#define BANKERS_PROTO_H
+#include <stdint.h>
+
+#define PROTO_VERSION 2 // Returned in PROTO_INFO replies (2 added PROTO_HEADROOM)
+#define PROTO_INFO 1 // Request: no payload. Reply: process = rows, payload [version, rows, cols, isSafe]
+#define PROTO_REQUEST 2 // Request: process, payload cols amounts. Reply: status BANKER_OK (granted) or BANKER_DENY_*/BANKER_INVALID
+#define PROTO_RELEASE 3 // Request: process, payload cols amounts. Reply: status BANKER_OK, BANKER_DENY_ALLOCATED or BANKER_INVALID
+#define PROTO_ADD 4 // Request: payload cols maximum claims (process ignored). Reply: status, process = index of added process
+#define PROTO_QUERY 5 // Request: no payload. Reply: status 1 if safe, process = queued, payload sequence (queued ints). Read-only
+#define PROTO_AVAILABLE 6 // Request: no payload. Reply: payload cols available units. Not a safe grant: the safety check still runs on a request, which may be denied BANKER_DENY_UNSAFE. Read-only
+#define PROTO_HEADROOM 7 // Request: process, no payload. Reply: status BANKER_OK, BANKER_DENY_UNSAFE (all 0) or BANKER_INVALID (no payload), payload cols largest safe grant of each resource on its own (as bankersAlgo -m). Read-only
+#define PROTO_OP_COUNT 8 // Ops are 1..PROTO_OP_COUNT-1
+#define PROTO_BAD_FRAME -100 // Reply status: unknown op or payload size wrong for op
+
+#define FRAME_OK 0 // readFrame/sendFrame results
+#define FRAME_CLOSED 1 // Peer closed connection (or read/write failed)
+#define FRAME_TOO_LARGE 2 // Payload over buffer (payload skipped, frame header still valid)
+
+typedef struct protoHeader { // 16 bytes
+    uint32_t length; // Payload bytes following header (multiple of 4)
+    uint16_t op; // PROTO_* (replies echo the request op)
+    int16_t status; // Reply: result of op (BANKER_* or PROTO_BAD_FRAME), 0 in requests
+    int32_t process; // Process index of request/release, see op for replies
+    uint32_t epoch; // Reply: state epoch answered from (bumped by every granted change)
+} protoHeader;
+
+int readFrame(int,protoHeader*,int32_t*,uint32_t); // Reads one whole frame (retries short reads/EINTR). Params: fd,outputHeader,outputPayload,payloadCapacity(bytes). Returns FRAME_*
+int sendFrame(int,const protoHeader*,const int32_t*); // Writes header + payload in one writev (retries short writes, no SIGPIPE). Params: fd,header,payload(header length bytes, NULL if 0). Returns FRAME_OK or FRAME_CLOSED
+int connectSocket(const char*); // Connects to daemon socket. Takes: path. Returns fd, -1 if failed
+
+#endif
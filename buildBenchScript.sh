@@ -0,0 +1,23 @@
+#!/bin/bash
+# Compile banker library (same flags as buildScript.sh, so timings match the shipped library)
+if ! ((gcc -O2 -fPIC -pthread -c bankersLib.c -o bankersLib.o) && (ar rcs libbankers.a bankersLib.o)); then
+    echo "ERROR : Could not compile ./libbankers.a"
+    exit 1
+fi
+
+# Compile workload generator + benchmark harness (WILL NOT EXECUTE FILE)
+if (gcc -O2 -pthread bankersBench.c bankersIO.c libbankers.a -o bankersBench); then
+    echo "Compiled to ./bankersBench"
+fi
+
+# Compile daemon load generator (WILL NOT EXECUTE FILE)
+if (gcc -O2 -pthread bankersLoad.c bankersProto.c -o bankersLoad); then
+    echo "Compiled to ./bankersLoad"
+fi
+
+# Generate one workload via:
+# ./bankersBench -g ./unsafe1000.txt -n 1000 -m 16 -t unsafe -s 7
+# Default sweep (10^2..10^6 processes, 1..512 resources) to CSV via:
+# ./bankersBench -L myBuild ./results.csv
+# Load test a running daemon (8 clients, 5 s, 90% reads) via:
+# ./bankersLoad -c 8 -t 5 -q 90 /tmp/bankers.sock
\ No newline at end of file
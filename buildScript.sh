@@ -16,12 +16,24 @@ if $test; then
     echo "Dependancies exist!"
 fi
 
-# Compile bankersAlgorithm program to binary (WILL NOT EXECUTE FILE)
-if (gcc bankersAlgo.c -o bankersAlgo); then
+# Compile banker library (static + shared), for embedding in other programs (see bankersLib.h)
+if (gcc -O2 -fPIC -pthread -c bankersLib.c -o bankersLib.o) && (ar rcs libbankers.a bankersLib.o) && (gcc -shared -pthread bankersLib.o -o libbankers.so); then
+    echo "Compiled to ./libbankers.a and ./libbankers.so"
+fi
+
+# Compile bankersAlgorithm program to binary, linked against static library (WILL NOT EXECUTE FILE)
+if (gcc -pthread bankersAlgo.c bankersIO.c libbankers.a -o bankersAlgo); then
     echo "Compiled to ./bankersAlgo"
 fi
 
+# Compile admission-control daemon (Unix socket server, see bankersProto.h), linked against static library (WILL NOT EXECUTE FILE)
+if (gcc -pthread bankersDaemon.c bankersProto.c bankersIO.c libbankers.a -o bankersDaemon); then
+    echo "Compiled to ./bankersDaemon"
+fi
+
 # Standard file execution done via:
 # ./bankersAlgo ./sampleInputFile.txt | grep OUTPUT | cut -d ':' -f 2
 # With all debug information via:
-# ./bankersAlgo ./sampleInputFile.txt
\ No newline at end of file
+# ./bankersAlgo ./sampleInputFile.txt
+# Daemon via:
+# ./bankersDaemon /tmp/bankers.sock ./sampleInputFile.txt
\ No newline at end of file
@@ -0,0 +1,188 @@
+#!/bin/bash
+# Script to run regression checks (sample logs + differential checks on generated states)
+# - Compares runScript.sh output against sampleRun.log, then generates safe, barely and
+#       unsafe states with bankersBench and checks that every verdict matches the kind and
+#       that kernels, threads, binary records and sparse storage give the same result as the default run.
+# - What-if (-w) grant bits are checked against sampleWhatIfRun.log and against stream (-i) runs of each candidate.
+# - Headroom (-m) values are checked against sampleHeadroomRun.log, and each value h of generated states by -w (h granted, h+1 denied),
+#       and bankersDaemon HEADROOM replies against sampleHeadroomRun.log.
+# - Priority scheduling (-q) sequences and costs are checked against samplePriorityRun.log and a rescan reference.
+# - Exit code is the number of failed checks.
+
+# Ensure programs compiled
+if ! test -f ./bankersAlgo || ! test -f ./bankersBench || ! test -f ./bankersDaemon || ! test -f ./bankersLoad; then
+    echo "ERROR : './bankersAlgo', './bankersDaemon', './bankersBench' or './bankersLoad' does not exist. Run './buildScript.sh' and './buildBenchScript.sh' first."
+    exit 1;
+fi
+
+failed=0
+checkDir=$(mktemp -d)
+trap 'rm -rf "$checkDir"' EXIT
+
+# Compares two outputs. Params: name,expected,actual
+checkSame() {
+    if [ "$2" != "$3" ]; then
+        echo "ERROR : Check failed ($1)."
+        failed=$((failed+1))
+    fi
+}
+
+# Sample logs
+checkSame "sampleRun.log" "$(cat ./sampleRun.log)" "$(bash ./runScript.sh)"
+
+# Generated states, widths around the AVX2/SSE2 tail (12..15) and the 8 int row padding
+for kind in safe barely unsafe; do
+    for cols in 1 8 13 64; do
+        name="$kind ${cols}col"
+        state="$checkDir/$kind$cols.txt"
+        ./bankersBench -g "$state" -n 2000 -m $cols -t $kind -s $cols > /dev/null
+        expected="SAFE"
+        if [ $kind = unsafe ]; then expected="UNSAFE"; fi
+        checkSame "$name verdict" "$expected" "$(./bankersAlgo -o verdict "$state")"
+        sequence=$(./bankersAlgo -o sequence "$state")
+        for kernels in scalar sse2 avx2; do
+            checkSame "$name -k $kernels" "$sequence" "$(./bankersAlgo -o sequence -k $kernels "$state")"
+        done
+        checkSame "$name -j 4 -s" "$sequence" "$(./bankersAlgo -o sequence -j 4 -s "$state")"
+        checkSame "$name -p verdict" "$expected" "$(./bankersAlgo -o verdict -p "$state")"
+        checkSame "$name -p -j 4" "$(./bankersAlgo -o sequence -p "$state")" "$(./bankersAlgo -o sequence -p -j 4 "$state")"
+        ./bankersAlgo -c "$state" "$checkDir/$kind$cols.bin" > /dev/null
+        checkSame "$name binary" "$sequence" "$(./bankersAlgo -o sequence "$checkDir/$kind$cols.bin")"
+    done
+done
+
+# Sparse storage, low density states (3% non-zero), verdicts and sequences must match dense storage
+for kind in safe barely unsafe; do
+    name="$kind sparse"
+    state="$checkDir/${kind}Sparse.txt"
+    ./bankersBench -g "$state" -n 3000 -m 40 -d 3 -t $kind -s 11 > /dev/null
+    sequence=$(./bankersAlgo -o sequence -z dense "$state")
+    checkSame "$name -z sparse" "$sequence" "$(./bankersAlgo -o sequence -z sparse "$state")"
+    checkSame "$name -z auto" "$sequence" "$(./bankersAlgo -o sequence "$state")"
+    checkSame "$name -p" "$(./bankersAlgo -o sequence -p -z dense "$state")" "$(./bankersAlgo -o sequence -p -z sparse "$state")"
+    checkSame "$name csv" "$(./bankersAlgo -o csv -z dense "$state")" "$(./bankersAlgo -o csv -z sparse "$state")"
+done
+
+# What-if candidates, sample against its log, then generated candidates bit by bit against a stream (-i) run of that request alone
+checkSame "sampleWhatIfRun.log" "$(cat ./sampleWhatIfRun.log)" "$(./bankersAlgo -o csv -w ./sampleWhatIfFile.txt ./sampleInputFile.txt)"
+checkSame "sampleWhatIfRun.log -j 4" "$(cat ./sampleWhatIfRun.log)" "$(./bankersAlgo -o csv -j 4 -w ./sampleWhatIfFile.txt ./sampleInputFile.txt)"
+for kind in safe barely; do
+    state="$checkDir/${kind}WhatIf.txt"
+    candidates="$checkDir/${kind}Candidates.txt"
+    ./bankersBench -g "$state" -n 200 -m 6 -d 40 -t $kind -s 21 > /dev/null
+    RANDOM=21
+    expected=""
+    for i in $(seq 40); do # 1-3 units of one resource, a mix of grants, unsafe and over-claim denials
+        col=$((RANDOM % 6))
+        candidate="P$((RANDOM % 200))"
+        for j in 0 1 2 3 4 5; do
+            if [ $j = $col ]; then candidate="$candidate $((RANDOM % 3 + 1))"; else candidate="$candidate 0"; fi
+        done
+        echo "$candidate" >> "$candidates"
+        if echo "REQUEST $candidate" | ./bankersAlgo -o verdict -i "$state" | grep -q "GRANT"; then expected="${expected}1"; else expected="${expected}0"; fi
+    done
+    checkSame "$kind -w" "$expected" "$(./bankersAlgo -o sequence -w "$candidates" "$state")"
+    checkSame "$kind -w -j 4" "$expected" "$(./bankersAlgo -o sequence -j 4 -w "$candidates" "$state")"
+    checkSame "$kind -w -z sparse" "$expected" "$(./bankersAlgo -o sequence -z sparse -w "$candidates" "$state")"
+done
+
+# Headroom, sample against its log, then generated states: every value h must be granted by -w and h+1 denied (all 0 if unsafe),
+#       and single-process rows (-m P) must match the -m all matrix
+checkSame "sampleHeadroomRun.log" "$(cat ./sampleHeadroomRun.log)" "$(./bankersAlgo -m all -o sequence ./sampleInputFile.txt)"
+for kind in safe barely unsafe; do
+    state="$checkDir/${kind}Headroom.txt"
+    candidates="$checkDir/${kind}HeadroomCandidates.txt"
+    ./bankersBench -g "$state" -n 60 -m 5 -d 40 -t $kind -s 31 > /dev/null
+    matrix=$(./bankersAlgo -m all -o sequence "$state")
+    checkSame "$kind -m all -j 4" "$matrix" "$(./bankersAlgo -m all -o sequence -j 4 "$state")"
+    checkSame "$kind -m all -z sparse" "$matrix" "$(./bankersAlgo -m all -o sequence -z sparse "$state")"
+    ./bankersAlgo -c "$state" "$checkDir/${kind}Headroom.bin" > /dev/null
+    checkSame "$kind -m all binary" "$matrix" "$(./bankersAlgo -m all -o sequence "$checkDir/${kind}Headroom.bin")"
+    for p in 0 17 59; do
+        checkSame "$kind -m P$p" "$(echo "$matrix" | sed -n "$((p+1))p")" "$(./bankersAlgo -m P$p -o sequence "$state")"
+    done
+    if [ $kind = unsafe ]; then # Nothing can be granted, even 0 units are denied as unsafe
+        checkSame "$kind -m all zero" "" "$(echo "$matrix" | tr -d ' 0\n')"
+        continue
+    fi
+    echo "$matrix" | awk '{ for (r = 1; r <= NF; ++r) for (extra = 0; extra <= 1; ++extra) {
+        line = "P" (NR-1); for (j = 1; j <= NF; ++j) line = line " " ((j == r) ? $r + extra : 0); print line } }' > "$candidates"
+    expected=$(echo "$matrix" | awk '{ for (r = 1; r <= NF; ++r) printf "10" } END { printf "\n" }')
+    checkSame "$kind -m vs -w" "$expected" "$(./bankersAlgo -o sequence -w "$candidates" "$state")"
+done
+
+# Daemon HEADROOM replies against sampleHeadroomRun.log (reads only, so every reply is from epoch 0)
+socket="$checkDir/bankers.sock"
+./bankersDaemon "$socket" ./sampleInputFile.txt > /dev/null &
+daemonPid=$!
+for i in $(seq 50); do
+    if test -S "$socket"; then break; fi
+    sleep 0.1
+done
+./bankersLoad -c 2 -t 1 -q 100 -s 0 -h 100 -m ./sampleHeadroomRun.log "$socket" > /dev/null
+checkSame "daemon headroom" "0" "$?"
+kill $daemonPid
+wait $daemonPid
+
+# Priority scheduling (-q), sample against its log, then generated states with a random priority section against
+#       a plain rescan reference (smallest key among ready processes, lowest index on ties)
+referenceSchedule() { # Prints sequence and weighted cost (or UNSAFE). Params: order,inputFile
+    awk -v mode=$1 '
+    NR == 1 { n = $1; m = $2; next }
+    /^[A-Za-z]/ { ++section; row = 0; next }
+    NF == 0 { next }
+    section == 1 { for (j = 1; j <= m; ++j) alloc[row,j] = $j; ++row }
+    section == 2 { for (j = 1; j <= m; ++j) need[row,j] = $j - alloc[row,j]; ++row }
+    section == 3 { for (j = 1; j <= m; ++j) avail[j] = $j }
+    section == 4 { priority[row] = $1; weight[row] = $2; ++row }
+    END {
+        for (i = 0; i < n; ++i) {
+            if (!(i in weight)) { priority[i] = 0; weight[i] = 1 }
+            total = 0
+            for (j = 1; j <= m; ++j) total += need[i,j]
+            key[i] = (mode == "priority") ? priority[i] : (mode == "weight") ? -weight[i] : total
+        }
+        sequence = ""; cost = 0
+        for (position = 1; position <= n; ++position) {
+            best = -1
+            for (i = 0; i < n; ++i) {
+                if (done[i]) continue
+                ready = 1
+                for (j = 1; j <= m && ready; ++j) if (need[i,j] > avail[j]) ready = 0
+                if (ready && (best == -1 || key[i] < key[best])) best = i
+            }
+            if (best == -1) { print "UNSAFE"; exit }
+            done[best] = 1
+            for (j = 1; j <= m; ++j) avail[j] += alloc[best,j]
+            sequence = sequence ((position > 1) ? " > " : "") "P" best
+            cost += weight[best] * position
+        }
+        print sequence; printf "%.0f\n", cost # Exact up to 2^53, print would round large costs
+    }
+    ' "$2"
+}
+checkSame "samplePriorityRun.log" "$(cat ./samplePriorityRun.log)" "$(for order in priority weight shortest; do ./bankersAlgo -q $order -o sequence ./samplePriorityFile.txt; done)"
+sed 's/^0\t5$/0\t-2147483648/' ./samplePriorityFile.txt > "$checkDir/negativeWeight.txt" # Negative weights fail like negative array values
+./bankersAlgo -q weight -o sequence "$checkDir/negativeWeight.txt" > /dev/null
+checkSame "-q weight, negative weight rejected" "1" "$?"
+sed 's/^0\t5$/0\t2147483647/' ./samplePriorityFile.txt > "$checkDir/largestWeight.txt"
+checkSame "-q weight, largest weight" "$(referenceSchedule weight "$checkDir/largestWeight.txt")" "$(./bankersAlgo -q weight -o sequence "$checkDir/largestWeight.txt")"
+for kind in safe barely unsafe; do
+    state="$checkDir/${kind}Priority.txt"
+    ./bankersBench -g "$state" -n 80 -m 4 -d 40 -t $kind -s 41 > /dev/null
+    checkSame "$kind -q priority, no section" "$(./bankersAlgo -o sequence -p "$state")" "$(./bankersAlgo -o sequence -q priority "$state" | head -1)"
+    RANDOM=41
+    echo "Process priority and weight (n*2)" >> "$state"
+    for i in $(seq 80); do echo "$((RANDOM % 10))	$((RANDOM % 9 + 1))" >> "$state"; done
+    for order in priority weight shortest; do
+        expected=$(referenceSchedule $order "$state")
+        checkSame "$kind -q $order" "$expected" "$(./bankersAlgo -o sequence -q $order "$state")"
+        checkSame "$kind -q $order -j 4" "$expected" "$(./bankersAlgo -o sequence -j 4 -q $order "$state")"
+        checkSame "$kind -q $order -z sparse" "$expected" "$(./bankersAlgo -o sequence -z sparse -q $order "$state")"
+    done
+done
+
+if [ $failed -eq 0 ]; then
+    echo "INFO : All checks passed."
+fi
+exit $failed